@@ -24,6 +24,8 @@
 #include "OpenSprinkler.h"
 #include "server.h"
 #include "defines.h"
+#include "connpool.h"
+#include "relaytrace.h"
 
 /** Declare static data members */
 NVConData OpenSprinkler::nvdata;
@@ -56,6 +58,15 @@ const char ifkey_filename[]  PROGMEM = IFTTT_KEY_FILENAME;
 const char wifi_filename[]   PROGMEM = WIFI_FILENAME;
 byte OpenSprinkler::state = OS_STATE_INITIAL;
 byte OpenSprinkler::prev_station_bits[MAX_EXT_BOARDS+1];
+byte OpenSprinkler::station_special_types[MAX_NUM_STATIONS];
+ulong OpenSprinkler::spe_refresh_time[MAX_NUM_STATIONS];
+byte OpenSprinkler::spe_refresh_fails[MAX_NUM_STATIONS];
+byte OpenSprinkler::relay_pins[MAX_NUM_STATIONS];
+ulong OpenSprinkler::data_gens[NUM_DATA_GENS];
+ulong OpenSprinkler::boot_id;
+char OpenSprinkler::password_cache[MAX_USER_PASSWORD];
+bool OpenSprinkler::password_cached = false;
+byte OpenSprinkler::relay_active[MAX_NUM_STATIONS];
 WiFiConfig OpenSprinkler::wifi_config = {WIFI_MODE_AP, "", ""};
 
 extern ESP8266WebServer *wifi_server;
@@ -341,33 +352,47 @@ void OpenSprinkler::reboot_dev() {
 
 extern void flow_isr();
 
+/** On-board relay pin of a station (255 if none) */
+static byte onboard_relay_pin(byte sid) {
+  switch(sid) {
+    case 0: return PIN_RELAY_1;
+    case 1: return PIN_RELAY_2;
+    case 2: return PIN_RELAY_3;
+    case 3: return PIN_RELAY_4;
+    case 4: return PIN_RELAY_5;
+    case 5: return PIN_RELAY_6;
+    case 6: return PIN_RELAY_7;
+    case 7: return PIN_RELAY_8;
+  }
+  return 255;
+}
+
 /** Initialize pins, controller variables, LCD */
 void OpenSprinkler::begin() {
 
   hw_type = HW_TYPE_UNKNOWN;
+  boot_id = RANDOM_REG32;  // hardware random number generator
+
+  // Set up on-board relays
+  // GPIO stations replace their relay pin once the special station data is loaded
+  byte sid;
+  for(sid=0;sid<MAX_NUM_STATIONS;sid++) {
+    relay_pins[sid] = onboard_relay_pin(sid);
+    relay_active[sid] = HIGH;
+    if(relay_pins[sid]==255) continue;
+    pinMode(relay_pins[sid], OUTPUT);
+    digitalWrite(relay_pins[sid], LOW);
+  }
 
 	// Reset all stations
   clear_all_station_bits();
   apply_all_station_bits();
-
-  pinMode(PIN_RELAY_1, OUTPUT);
-  pinMode(PIN_RELAY_2, OUTPUT);
-  pinMode(PIN_RELAY_3, OUTPUT);
-  pinMode(PIN_RELAY_4, OUTPUT);
-  pinMode(PIN_RELAY_5, OUTPUT);
-  pinMode(PIN_RELAY_6, OUTPUT);
-  pinMode(PIN_RELAY_7, OUTPUT);
-  pinMode(PIN_RELAY_8, OUTPUT);
-  digitalWrite(PIN_RELAY_1, LOW);
-  digitalWrite(PIN_RELAY_2, LOW);
-  digitalWrite(PIN_RELAY_3, LOW);
-  digitalWrite(PIN_RELAY_4, LOW);
-  digitalWrite(PIN_RELAY_5, LOW);
-  digitalWrite(PIN_RELAY_6, LOW);
-  digitalWrite(PIN_RELAY_7, LOW);
-  digitalWrite(PIN_RELAY_8, LOW);
   
   pinMode(PIN_LED, OUTPUT);
+  if(PIN_RFTX!=255) {
+    pinMode(PIN_RFTX, OUTPUT);
+    digitalWrite(PIN_RFTX, 0);
+  }
   // Set up sensors
   /* todo: handle two sensors */
   pinMode(PIN_RAINSENSOR, INPUT_PULLUP);
@@ -412,19 +437,48 @@ void OpenSprinkler::begin() {
  * !!! This will activate/deactivate valves !!!
  */
 void OpenSprinkler::apply_all_station_bits() {
-    
-  byte bid, s, sbits;  
+
+  // write the relay pins of all stations that changed since the last call
+  // pins 0-15 are set and cleared in one register write each, pin 16 is separate
+  uint32_t set_mask = 0, clr_mask = 0;
+  byte bid, s, sid, pin, on, changed;
+  for(bid=0;bid<=MAX_EXT_BOARDS;bid++) {
+    changed = station_bits[bid] ^ prev_station_bits[bid];
+    prev_station_bits[bid] = station_bits[bid];
+    for(s=0;changed && s<8;s++,changed>>=1) {
+      sid = (bid<<3)+s;
+      if(!(changed&1) || sid>=MAX_NUM_STATIONS) continue;
+      pin = relay_pins[sid];
+      if(pin==255) continue;
+      on = ((station_bits[bid]>>s)&1) ? relay_active[sid] : !relay_active[sid];
+      if(pin<16) {
+        if(on) set_mask |= (1UL<<pin);
+        else   clr_mask |= (1UL<<pin);
+      } else {
+        digitalWrite(pin, on);
+      }
+    }
+  }
+  if(clr_mask) GPOC = clr_mask;
+  if(set_mask) GPOS = set_mask;
 
   if(options[OPTION_SPE_AUTO_REFRESH]) {
-    // handle refresh of RF and remote stations
-    // we refresh the station whose index is the current time modulo MAX_NUM_STATIONS
-    static byte last_sid = 0;
-    byte sid = now() % MAX_NUM_STATIONS;
-    if (sid != last_sid) {  // avoid refreshing the same station twice in a roll
-      last_sid = sid;
-      bid=sid>>3;
-      s=sid&0x07;
-      switch_special_station(sid, (station_bits[bid]>>s)&0x01);
+    // handle refresh of special stations (RF, remote, HTTP)
+    // GPIO stations hold their level and need no refresh
+    // each special station has its own refresh deadline, and
+    // at most one station (the most overdue one) is refreshed per second
+    static ulong last_time = 0;
+    ulong curr_time = millis() / 1000;
+    if (curr_time == last_time) return;  // avoid refreshing twice in a second
+    last_time = curr_time;
+    byte next = 255;
+    for(sid=0;sid<nstations;sid++) {
+      if(station_special_types[sid]==STN_TYPE_STANDARD || station_special_types[sid]==STN_TYPE_GPIO) continue;
+      if((long)(curr_time-spe_refresh_time[sid])<0) continue;
+      if(next==255 || (long)(spe_refresh_time[sid]-spe_refresh_time[next])<0) next = sid;
+    }
+    if(next!=255) {
+      switch_special_station(next, (station_bits[next>>3]>>(next&0x07))&0x01);
     }
   }
 }
@@ -478,7 +532,7 @@ uint16_t OpenSprinkler::parse_rfstation_code(RFStationData *data, ulong* on, ulo
   if (!v) return 0;
   if (off) *off = v;
 	v = hex2ulong(data->timing, sizeof(data->timing));
-  if (!v) return 0;
+  if (!v || v>RF_MAX_PULSE_US) return 0;
   return v;
 }
 
@@ -492,11 +546,13 @@ void OpenSprinkler::get_station_name(byte sid, char tmp[]) {
 void OpenSprinkler::set_station_name(byte sid, char tmp[]) {
   tmp[STATION_NAME_SIZE]=0;
   nvm_write_block(tmp, (void*)(ADDR_NVM_STN_NAMES+(int)sid*STATION_NAME_SIZE), STATION_NAME_SIZE);
+  data_changed(DATA_GEN_STATIONS);
 }
 
 /** Save station attribute bits to NVM */
 void OpenSprinkler::station_attrib_bits_save(int addr, byte bits[]) {
   nvm_write_block(bits, (void*)addr, MAX_EXT_BOARDS+1);
+  data_changed(DATA_GEN_STATIONS);
 }
 
 /** Load all station attribute bits from NVM */
@@ -509,23 +565,36 @@ byte OpenSprinkler::station_attrib_bits_read(int addr) {
   return nvm_read_byte((byte*)addr);
 }
 
-/** verify if a string matches password */
+/** verify if a string matches password
+ * The password is read from NVM once and then kept in RAM.
+ * The comparison always runs over the full password size,
+ * so its time does not tell how much of pw matched.
+ */
 byte OpenSprinkler::password_verify(char *pw) {
-  byte *addr = (byte*)ADDR_NVM_PASSWORD;
-  byte c1, c2;
-  while(1) {
-    if(addr == (byte*)ADDR_NVM_PASSWORD+MAX_USER_PASSWORD)
-      c1 = 0;
-    else
-      c1 = nvm_read_byte(addr++);
-    c2 = *pw++;
-    if (c1==0 || c2==0)
-      break;
-    if (c1!=c2) {
-      return 0;
-    }
+  if(!password_cached) {
+    nvm_read_block(password_cache, (void*)ADDR_NVM_PASSWORD, MAX_USER_PASSWORD);
+    password_cache[MAX_USER_PASSWORD-1] = 0;
+    // clear whatever follows the end of the password
+    byte len = strlen(password_cache);
+    memset(password_cache+len, 0, MAX_USER_PASSWORD-len);
+    password_cached = true;
+  }
+  byte diff = 0;
+  bool end = false;
+  for(byte i=0;i<MAX_USER_PASSWORD;i++) {
+    char c = end ? 0 : pw[i];
+    if(!c) end = true;
+    diff |= password_cache[i]^c;
   }
-  return (c1==c2) ? 1 : 0;
+  return diff ? 0 : 1;
+}
+
+/** Store a new password */
+void OpenSprinkler::password_set(const char *pw) {
+  memset(password_cache, 0, MAX_USER_PASSWORD);
+  strncpy(password_cache, pw, MAX_USER_PASSWORD-1);
+  nvm_write_block(password_cache, (void*)ADDR_NVM_PASSWORD, strlen(password_cache)+1);
+  password_cached = true;
 }
 
 // ==================
@@ -539,33 +608,103 @@ byte OpenSprinkler::weekday_today() {
   return (wd+3) % 7;  // Jan 1, 1970 is a Thursday
 }
 
-/** Switch special station */
-void OpenSprinkler::switch_special_station(byte sid, byte value) {
-  // check station special bit
-  if(station_attrib_bits_read(ADDR_NVM_STNSPE+(sid>>3))&(1<<(sid&0x07))) {
-    // read station special data from sd card
-    int stepsize=sizeof(StationSpecialData);
-    read_from_file(stns_filename, tmp_buffer, stepsize, sid*stepsize);
-    StationSpecialData *stn = (StationSpecialData *)tmp_buffer;
-    // check station type
-    if(stn->type==STN_TYPE_RF) {
-      // transmit RF signal
-      switch_rfstation((RFStationData *)stn->data, value);
-    } else if(stn->type==STN_TYPE_REMOTE) {
-      // request remote station
-      switch_remotestation((RemoteStationData *)stn->data, value);
+/** Load cached special station types and the relay pin table
+ * Must be called whenever station special bits or special data change
+ */
+void OpenSprinkler::station_special_load() {
+  byte sid, j, bits = 0, pin, active;
+  byte pins[MAX_NUM_STATIONS], actives[MAX_NUM_STATIONS];
+  ulong curr_time = millis() / 1000;
+  int stepsize=sizeof(StationSpecialData);
+  StationSpecialData *stn = (StationSpecialData *)tmp_buffer;
+  for(sid=0;sid<MAX_NUM_STATIONS;sid++) {
+    if((sid&0x07)==0) bits = station_attrib_bits_read(ADDR_NVM_STNSPE+(sid>>3));
+    station_special_types[sid] = STN_TYPE_STANDARD;
+    pin = onboard_relay_pin(sid);
+    active = HIGH;
+    if(bits&(1<<(sid&0x07))) {
+      read_from_file(stns_filename, tmp_buffer, stepsize, sid*stepsize);
+      station_special_types[sid] = stn->type;
+      // a GPIO station drives its own pin instead of the on-board relay,
+      // unless the pin is invalid or already driven by a station before it
+      if(stn->type==STN_TYPE_GPIO) {
+        bool ok = parse_gpiostation((GPIOStationData *)stn->data, &pin, &active);
+        for(j=0;ok && j<sid;j++) {
+          if(pins[j]==pin) ok = false;
+        }
+        if(!ok) {
+          station_special_types[sid] = STN_TYPE_STANDARD;
+          pin = onboard_relay_pin(sid);
+          active = HIGH;
+        }
+      }
     }
-    // GPIO and HTTP stations are only available for OS23 or OSPi
-    else if(stn->type==STN_TYPE_GPIO) {
-      // set GPIO pin
-      switch_gpiostation((GPIOStationData *)stn->data, value);
-    } else if(stn->type==STN_TYPE_HTTP) {
-      // send GET command
-      switch_httpstation((HTTPStationData *)stn->data, value);
+    pins[sid] = pin;
+    actives[sid] = active;
+    // stagger the first refresh of each station by one second
+    spe_refresh_time[sid] = curr_time + sid;
+    spe_refresh_fails[sid] = 0;
+  }
+  // release the pins that change first, as a released pin may be taken by another station
+  for(sid=0;sid<MAX_NUM_STATIONS;sid++) {
+    if(relay_pins[sid]==255 || (pins[sid]==relay_pins[sid] && actives[sid]==relay_active[sid])) continue;
+    digitalWrite(relay_pins[sid], !relay_active[sid]);
+  }
+  // then configure the new pins and bring them to the current station state
+  for(sid=0;sid<MAX_NUM_STATIONS;sid++) {
+    if(pins[sid]==relay_pins[sid] && actives[sid]==relay_active[sid]) continue;
+    relay_pins[sid] = pin = pins[sid];
+    relay_active[sid] = active = actives[sid];
+    if(pin!=255) {
+      byte on = (station_bits[sid>>3]>>(sid&0x07))&1;
+      pinMode(pin, OUTPUT);
+      digitalWrite(pin, on ? active : !active);
     }
   }
 }
 
+/** Whether a station other than sid drives the given pin */
+bool OpenSprinkler::relay_pin_in_use(byte pin, byte sid) {
+  for(byte i=0;i<MAX_NUM_STATIONS;i++) {
+    if(i!=sid && relay_pins[i]==pin) return true;
+  }
+  return false;
+}
+
+/** Switch special station
+ * Returns false if the station could not be reached
+ */
+bool OpenSprinkler::switch_special_station(byte sid, byte value) {
+  byte type = station_special_types[sid];
+  if(type==STN_TYPE_STANDARD || type==STN_TYPE_GPIO) return true;
+  // read station special data from sd card
+  int stepsize=sizeof(StationSpecialData);
+  read_from_file(stns_filename, tmp_buffer, stepsize, sid*stepsize);
+  StationSpecialData *stn = (StationSpecialData *)tmp_buffer;
+  bool ok = true;
+  // check station type
+  if(type==STN_TYPE_RF) {
+    // transmit RF signal
+    switch_rfstation((RFStationData *)stn->data, value);
+  } else if(type==STN_TYPE_REMOTE) {
+    // request remote station
+    ok = switch_remotestation((RemoteStationData *)stn->data, value);
+  }
+  // GPIO stations are switched along with the on-board relays in apply_all_station_bits
+  else if(type==STN_TYPE_HTTP) {
+    // send GET command
+    ok = switch_httpstation((HTTPStationData *)stn->data, value);
+  }
+
+  // every switch counts as a refresh, so schedule the next auto refresh from now on
+  // stations that fail to respond are backed off exponentially (this is the only
+  // back-off: the connection pool tries a remote whenever it is asked to)
+  if(ok) spe_refresh_fails[sid] = 0;
+  else if(spe_refresh_fails[sid]<SPE_REFRESH_MAX_BACKOFF) spe_refresh_fails[sid]++;
+  spe_refresh_time[sid] = millis()/1000 + ((ulong)SPE_REFRESH_INTERVAL<<spe_refresh_fails[sid]);
+  return ok;
+}
+
 /** Set station bit
  * This function sets/resets the corresponding station bit variable
  * You have to call apply_all_station_bits next to apply the bits
@@ -578,66 +717,16 @@ byte OpenSprinkler::set_station_bit(byte sid, byte value) {
     if((*data)&mask) return 0;  // if bit is already set, return no change
     else {
       (*data) = (*data) | mask;
+      relaytrace_add(sid, 1);
       switch_special_station(sid, 1); // handle special stations
-      switch (sid) {
-        case 0:
-          digitalWrite(PIN_RELAY_1, HIGH);
-          break;
-        case 1:
-          digitalWrite(PIN_RELAY_2, HIGH);
-          break;
-        case 2:
-          digitalWrite(PIN_RELAY_3, HIGH);
-          break;
-        case 3:
-          digitalWrite(PIN_RELAY_4, HIGH);
-          break;
-        case 4:
-          digitalWrite(PIN_RELAY_5, HIGH);
-          break;
-        case 5:
-          digitalWrite(PIN_RELAY_6, HIGH);
-          break;
-        case 6:
-          digitalWrite(PIN_RELAY_7, HIGH);
-          break;
-        case 7:
-          digitalWrite(PIN_RELAY_8, HIGH);
-          break;
-      }
       return 1;
     }
   } else {
     if(!((*data)&mask)) return 0; // if bit is already reset, return no change
     else {
       (*data) = (*data) & (~mask);
+      relaytrace_add(sid, 0);
       switch_special_station(sid, 0); // handle special stations
-      switch (sid) {
-        case 0:
-          digitalWrite(PIN_RELAY_1, LOW);
-          break;
-        case 1:
-          digitalWrite(PIN_RELAY_2, LOW);
-          break;
-        case 2:
-          digitalWrite(PIN_RELAY_3, LOW);
-          break;
-        case 3:
-          digitalWrite(PIN_RELAY_4, LOW);
-          break;
-        case 4:
-          digitalWrite(PIN_RELAY_5, LOW);
-          break;
-        case 5:
-          digitalWrite(PIN_RELAY_6, LOW);
-          break;
-        case 6:
-          digitalWrite(PIN_RELAY_7, LOW);
-          break;
-        case 7:
-          digitalWrite(PIN_RELAY_8, LOW);
-          break;
-      }
       return 255;
     }
   }
@@ -647,37 +736,103 @@ byte OpenSprinkler::set_station_bit(byte sid, byte value) {
 /** Clear all station bits */
 void OpenSprinkler::clear_all_station_bits() {
   byte sid;
-  for(sid=0;sid<=MAX_NUM_STATIONS;sid++) {
+  for(sid=0;sid<MAX_NUM_STATIONS;sid++) {
     set_station_bit(sid, 0);
   }
 }
 
-/** Transmit one RF signal bit */
-void transmit_rfbit(ulong lenH, ulong lenL) {
-    digitalWrite(PIN_RFTX, 1);
-    delayMicroseconds(lenH);
-    digitalWrite(PIN_RFTX, 0);
-    delayMicroseconds(lenL);
+/** RF transmitter
+ * RF codes are sent in the background by timer1:
+ * each code is precomputed into a pulse train of high/low durations
+ * which the timer interrupt plays back, so valves can switch
+ * without blocking the main loop and web server.
+ */
+#define RF_CODE_BITS    24
+#define RF_REPEATS      15  // number of times each code is sent
+#define RF_TRAIN_SIZE   ((RF_CODE_BITS+1)*2)  // high/low pair of each code bit, plus sync
+#define RF_QUEUE_SIZE   4   // codes waiting while a transmission is in progress
+#define RF_TICKS_PER_US 5   // timer1 runs at 80MHz/16
+#define RF_START_TICKS  50
+
+static volatile uint32_t rf_train[RF_TRAIN_SIZE]; // pulse durations (in timer ticks)
+static volatile byte rf_pos;      // position in the pulse train
+static volatile byte rf_repeat;   // repetition count of the current code
+static volatile bool rf_busy;     // transmission in progress
+static ulong    rf_queue_code[RF_QUEUE_SIZE];
+static uint16_t rf_queue_len[RF_QUEUE_SIZE];
+static volatile byte rf_queue_head, rf_queue_tail;
+
+/** Precompute the pulse train of a RF code
+ * len is at most RF_MAX_PULSE_US (checked by parse_rfstation_code),
+ * so the longest pulse, the sync gap, still fits timer1_write
+ */
+static ICACHE_RAM_ATTR void rf_build_train(ulong code, ulong len) {
+  uint32_t t1 = len * RF_TICKS_PER_US;
+  uint32_t t3 = t1 * 3;
+  byte k=0;
+  for(int i=RF_CODE_BITS-1;i>=0;i--) {
+    if ((code>>i) & 1) {
+      rf_train[k++] = t3;
+      rf_train[k++] = t1;
+    } else {
+      rf_train[k++] = t1;
+      rf_train[k++] = t3;
+    }
+  }
+  // sync
+  rf_train[k++] = t1;
+  rf_train[k] = t1 * 31;
 }
 
-/** Transmit RF signal */
-void send_rfsignal(ulong code, ulong len) {
-  ulong len3 = len * 3;
-  ulong len31 = len * 31;
-  for(byte n=0;n<15;n++) {
-    int i=23;
-    // send code
-    while(i>=0) {
-      if ((code>>i) & 1) {
-        transmit_rfbit(len3, len);
-      } else {
-        transmit_rfbit(len, len3);
+/** Timer1 interrupt: output the next pulse of the train */
+static ICACHE_RAM_ATTR void rf_timer_isr() {
+  if(rf_pos>=RF_TRAIN_SIZE) {
+    rf_pos = 0;
+    if(++rf_repeat>=RF_REPEATS) {
+      rf_repeat = 0;
+      if(rf_queue_head==rf_queue_tail) {
+        // nothing else to send
+        digitalWrite(PIN_RFTX, 0);
+        timer1_disable();
+        rf_busy = false;
+        return;
       }
-      i--;
-    };
-    // send sync
-    transmit_rfbit(len, len31);
+      rf_build_train(rf_queue_code[rf_queue_tail], rf_queue_len[rf_queue_tail]);
+      rf_queue_tail = (rf_queue_tail+1)%RF_QUEUE_SIZE;
+    }
   }
+  // even positions are high pulses, odd positions are low pulses
+  digitalWrite(PIN_RFTX, (rf_pos&1)?0:1);
+  timer1_write(rf_train[rf_pos++]);
+}
+
+/** Transmit RF signal
+ * Returns immediately: the code is sent in the background,
+ * or queued if another code is being sent.
+ */
+void send_rfsignal(ulong code, ulong len) {
+  if(PIN_RFTX==255 || !len) return;
+  noInterrupts();
+  if(rf_busy) {
+    byte next = (rf_queue_head+1)%RF_QUEUE_SIZE;
+    // if the queue is full the code is dropped,
+    // special station auto refresh will send it again
+    if(next!=rf_queue_tail) {
+      rf_queue_code[rf_queue_head] = code;
+      rf_queue_len[rf_queue_head] = len;
+      rf_queue_head = next;
+    }
+    interrupts();
+    return;
+  }
+  rf_busy = true;
+  interrupts();
+  rf_build_train(code, len);
+  rf_pos = 0;
+  rf_repeat = 0;
+  timer1_attachInterrupt(rf_timer_isr);
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+  timer1_write(RF_START_TICKS);
 }
 
 /** Switch RF station
@@ -688,26 +843,32 @@ void send_rfsignal(ulong code, ulong len) {
 void OpenSprinkler::switch_rfstation(RFStationData *data, bool turnon) {
   ulong on, off;
   uint16_t length = parse_rfstation_code(data, &on, &off);
-//  rfswitch.enableTransmit(PIN_RFTX);
-//  rfswitch.setPulseLength(length);
-//  rfswitch.setProtocol(1);
-//  rfswitch.send(turnon ? on : off, 24);
+  if(!length) return;
+  send_rfsignal(turnon ? on : off, length);
 }
 
-/** Switch GPIO station
+/** Parse GPIO station
  * Special data for GPIO Station is three bytes of ascii decimal (not hex)
  * First two bytes are zero padded GPIO pin number.
  * Third byte is either 0 or 1 for active low (GND) or high (+5V) relays
+ * Returns false if the data is malformed or the pin is not in PIN_FREE_LIST
  */
-void OpenSprinkler::switch_gpiostation(GPIOStationData *data, bool turnon) {
+bool OpenSprinkler::parse_gpiostation(GPIOStationData *data, byte *pin, byte *active) {
+  if(data->pin[0]<'0' || data->pin[0]>'9' || data->pin[1]<'0' || data->pin[1]>'9') return false;
   byte gpio = (data->pin[0] - '0') * 10 + (data->pin[1] - '0');
   byte activeState = data->active - '0';
-
-  pinMode(gpio, OUTPUT);
-  if (turnon)
-    digitalWrite(gpio, activeState);
-  else
-    digitalWrite(gpio, 1-activeState);
+  if(activeState>1) return false;
+
+  // the pin must not clash with pins in use by the controller
+  static const byte gpioList[] = PIN_FREE_LIST;
+  for(byte i=0;i<sizeof(gpioList);i++) {
+    if(gpioList[i]==gpio) {
+      *pin = gpio;
+      *active = activeState;
+      return true;
+    }
+  }
+  return false;
 }
 
 /** Callback function for browseUrl calls */
@@ -725,43 +886,25 @@ void httpget_callback(byte status, uint16_t off, uint16_t len) {
  * The remote controller is assumed to have the same
  * password as the main controller
  */
-void OpenSprinkler::switch_remotestation(RemoteStationData *data, bool turnon) {
+bool OpenSprinkler::switch_remotestation(RemoteStationData *data, bool turnon) {
 
   ulong ip = hex2ulong(data->ip, sizeof(data->ip));
   ulong port = hex2ulong(data->port, sizeof(data->port));
 
-  WiFiClient client;
-  
   char *p = tmp_buffer + sizeof(RemoteStationData) + 1;
-  BufferFiller bf = p;
-  // MAX_NUM_STATIONS is the refresh cycle
-  uint16_t timer = options[OPTION_SPE_AUTO_REFRESH]?2*MAX_NUM_STATIONS:64800;  
-  bf.emit_p(PSTR("GET /cm?pw=$E&sid=$D&en=$D&t=$D"),
+  BufferFiller bf(p, TMP_BUFFER_SIZE-sizeof(RemoteStationData)-1);
+  // SPE_REFRESH_INTERVAL is the refresh cycle
+  uint16_t timer = options[OPTION_SPE_AUTO_REFRESH]?2*SPE_REFRESH_INTERVAL:64800;  
+  bf.emit_p(PSTR("/cm?pw=$E&sid=$D&en=$D&t=$D"),
             ADDR_NVM_PASSWORD,
             (int)hex2ulong(data->sid, sizeof(data->sid)),
             turnon, timer);
-  bf.emit_p(PSTR(" HTTP/1.0\r\nHOST: *\r\n\r\n"));
-  
-  byte cip[4];
-  cip[0] = ip>>24;
-  cip[1] = (ip>>16)&0xff;
-  cip[2] = (ip>>8)&0xff;
-  cip[3] = ip&0xff;
-
-  if(!client.connect(IPAddress(cip), port))  return;
-  client.write((uint8_t *)p, strlen(p));
   
-  bzero(ether_buffer, ETHER_BUFFER_SIZE);
-  
-  time_t timeout = now_tz() + 5; // 5 seconds timeout
-  while(!client.available() && now_tz() < timeout) {
-  }
+  char server[16];
+  sprintf(server, "%d.%d.%d.%d", (int)(ip>>24), (int)((ip>>16)&0xff), (int)((ip>>8)&0xff), (int)(ip&0xff));
 
-  bzero(ether_buffer, ETHER_BUFFER_SIZE);
-  while(client.available()) {
-    client.read((uint8_t*)ether_buffer, ETHER_BUFFER_SIZE);
-  }
-  client.stop();
+  // repeated commands to the same remote controller reuse a keep-alive connection
+  return connpool_get(server, port, p, ether_buffer, ETHER_BUFFER_SIZE) > 0;
   //httpget_callback(0, 0, ETHER_BUFFER_SIZE);    
 }
 
@@ -769,7 +912,7 @@ void OpenSprinkler::switch_remotestation(RemoteStationData *data, bool turnon) {
  * This function takes an http station code,
  * parses it into a server name and two HTTP GET requests.
  */
-void OpenSprinkler::switch_httpstation(HTTPStationData *data, bool turnon) {
+bool OpenSprinkler::switch_httpstation(HTTPStationData *data, bool turnon) {
 
   static HTTPStationData copy;
   // make a copy of the HTTP station data and work with it
@@ -779,28 +922,15 @@ void OpenSprinkler::switch_httpstation(HTTPStationData *data, bool turnon) {
   char * on_cmd = strtok(NULL, ",");
   char * off_cmd = strtok(NULL, ",");
   char * cmd = turnon ? on_cmd : off_cmd;
- 
-  WiFiClient client;
-  if(!client.connect(server, atoi(port))) return;
-  
+  if(!server || !port || !cmd) return false;
+
   char getBuffer[255];
-  sprintf(getBuffer, "GET /%s HTTP/1.0\r\nHOST: *\r\n\r\n", cmd);
+  sprintf(getBuffer, "/%s", cmd);
   
   DEBUG_PRINTLN(getBuffer);
   
-  client.write((uint8_t *)getBuffer, strlen(getBuffer));
-  
-  bzero(ether_buffer, ETHER_BUFFER_SIZE);
-  
-  time_t timeout = now_tz() + 5; // 5 seconds timeout
-  while(!client.available() && now_tz() < timeout) {
-  }
-
-  bzero(ether_buffer, ETHER_BUFFER_SIZE);
-  while(client.available()) {
-    client.read((uint8_t*)ether_buffer, ETHER_BUFFER_SIZE);
-  }
-  client.stop();
+  // the server name is only looked up when the pool opens a new connection to it
+  return connpool_get(server, atoi(port), getBuffer, ether_buffer, ETHER_BUFFER_SIZE) > 0;
 }
 
 /** Setup function for options */
@@ -835,7 +965,7 @@ void OpenSprinkler::options_setup() {
     nvdata_save();
     lcd_print_line_clear_pgm(PSTR("1.Saving..."), 0); //DEBUG
     // 2. write string parameters
-    nvm_write_block(DEFAULT_PASSWORD, (void*)ADDR_NVM_PASSWORD, strlen(DEFAULT_PASSWORD)+1);
+    password_set(DEFAULT_PASSWORD);
     nvm_write_block(DEFAULT_LOCATION, (void*)ADDR_NVM_LOCATION, strlen(DEFAULT_LOCATION)+1);
     nvm_write_block(DEFAULT_JAVASCRIPT_URL, (void*)ADDR_NVM_JAVASCRIPTURL, strlen(DEFAULT_JAVASCRIPT_URL)+1);
     nvm_write_block(DEFAULT_WEATHER_URL, (void*)ADDR_NVM_WEATHERURL, strlen(DEFAULT_WEATHER_URL)+1);
@@ -884,6 +1014,9 @@ void OpenSprinkler::options_setup() {
 
     // load non-volatile controller data
     nvdata_load();
+
+    // load special station types
+    station_special_load();
   }
   lcd_print_line_clear_pgm(PSTR("Buttons_init-Start..."), 0);
 	byte button;// = button_read(BUTTON_WAIT_NONE);
@@ -1006,6 +1139,7 @@ void OpenSprinkler::options_save(bool savewifi) {
     tmp_buffer[i] = options[i];
   }
   nvm_write_block(tmp_buffer, (void*)ADDR_NVM_OPTIONS, NUM_OPTIONS);
+  data_changed(DATA_GEN_OPTIONS);
   nboards = options[OPTION_EXT_BOARDS]+1;
   nstations = nboards * 8;
   status.enabled = options[OPTION_DEVICE_ENABLE];
@@ -142,12 +142,17 @@ public:
   static void set_station_name(byte sid, char buf[]); // set station name
   static uint16_t parse_rfstation_code(RFStationData *data, ulong *on, ulong *off); // parse rf code into on/off/time sections
   static void switch_rfstation(RFStationData *data, bool turnon);  // switch rf station
-  static void switch_remotestation(RemoteStationData *data, bool turnon); // switch remote station
-  static void switch_gpiostation(GPIOStationData *data, bool turnon); // switch gpio station
-  static void switch_httpstation(HTTPStationData *data, bool turnon); // switch http station
+  static bool switch_remotestation(RemoteStationData *data, bool turnon); // switch remote station
+  static bool parse_gpiostation(GPIOStationData *data, byte *pin, byte *active); // parse and validate gpio station
+  static bool relay_pin_in_use(byte pin, byte sid);  // whether a station other than sid drives the pin
+  static bool switch_httpstation(HTTPStationData *data, bool turnon); // switch http station
+  static void station_special_load(); // load cached special station types
   static void station_attrib_bits_save(int addr, byte bits[]); // save station attribute bits to nvm
   static void station_attrib_bits_load(int addr, byte bits[]); // load station attribute bits from nvm
   static byte station_attrib_bits_read(int addr); // read one station attribte byte from nvm
+  static ulong data_gens[NUM_DATA_GENS];  // data generations
+  static ulong boot_id;                   // random id of this boot, distinguishes generations across reboots
+  static void data_changed(byte gen) { data_gens[gen]++; }  // bump a data generation
 
   // -- options and data storeage
   static void nvdata_load();
@@ -158,6 +163,9 @@ public:
   static void options_save(bool savewifi=false);
 
   static byte password_verify(char *pw);  // verify password
+  static void password_set(const char *pw); // store a new password
+  static char password_cache[MAX_USER_PASSWORD];  // RAM copy of the password in NVM
+  static bool password_cached;
   
   // -- controller operation
   static void enable();           // enable controller operation
@@ -171,7 +179,7 @@ public:
   static byte weekday_today();    // returns index of today's weekday (Monday is 0)
 
   static byte set_station_bit(byte sid, byte value); // set station bit of one station (sid->station index, value->0/1)
-  static void switch_special_station(byte sid, byte value); // swtich special station
+  static bool switch_special_station(byte sid, byte value); // swtich special station
   static void clear_all_station_bits(); // clear all station bits
   static void apply_all_station_bits(); // apply all station bits (activate/deactive values)
 
@@ -205,6 +213,11 @@ private:
   static void lcd_print_2digit(int v);  // print a integer in 2 digits
   static byte button_read_busy(byte pin_butt, byte waitmode, byte butt, byte is_holding);
   static byte prev_station_bits[];
+  static byte station_special_types[];  // cached special station types (STN_TYPE_STANDARD if not special)
+  static ulong spe_refresh_time[];      // next auto refresh time of each special station (in seconds since boot)
+  static byte spe_refresh_fails[];      // number of consecutive failed switches of each special station
+  static byte relay_pins[];             // output pin of each station (on-board relay or GPIO station pin, 255 if none)
+  static byte relay_active[];           // active level of each station's output pin
 // LCD functions
 };
 
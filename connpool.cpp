@@ -0,0 +1,211 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Keep-alive HTTP connection pool
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "connpool.h"
+
+static PooledConn pool[CONNPOOL_SIZE];
+
+/** Find the slot of a remote host:port
+ * If the remote is not in the pool yet, claim a free slot,
+ * or the least recently used one if the pool is full.
+ */
+static PooledConn* connpool_slot(const char *host, uint16_t port) {
+  PooledConn *c, *lru = pool;
+  bool fits = strlen(host)<CONNPOOL_HOST_SIZE;
+  for(c=pool;fits && c<pool+CONNPOOL_SIZE;c++) {
+    if(c->port==port && !strcmp(c->host, host)) return c;
+  }
+  for(c=pool;c<pool+CONNPOOL_SIZE;c++) {
+    if(!c->host[0]) { lru = c; break; }
+    if((long)(c->last_used-lru->last_used)<0) lru = c;
+  }
+  lru->client.stop();
+  // a name too long for the slot is used for this request only
+  if(fits) strcpy(lru->host, host);
+  else lru->host[0] = 0;
+  lru->port = port;
+  lru->ip = IPAddress();
+  lru->last_used = millis();
+  return lru;
+}
+
+/** Read one line (without CR/LF) from a client
+ * Returns the line length, or -1 on timeout or disconnect
+ */
+static int connpool_readline(WiFiClient &client, char *buf, int maxlen, ulong deadline) {
+  int n=0;
+  while(1) {
+    if(!client.available()) {
+      if(!client.connected() || (long)(millis()-deadline)>=0) return -1;
+      delay(0);
+      continue;
+    }
+    int c = client.read();
+    if(c=='\n') break;
+    if(c=='\r') continue;
+    if(n<maxlen-1) buf[n++] = c;
+  }
+  buf[n]=0;
+  return n;
+}
+
+/** Read len bytes of response body (len<0: read until the remote closes)
+ * As many bytes as fit are appended to resp, the rest is discarded
+ */
+static bool connpool_readbody(WiFiClient &client, long len, char *resp, int maxlen, int &pos, ulong deadline) {
+  char dump[32];
+  while(len!=0) {
+    int n = client.available();
+    if(!n) {
+      if(!client.connected()) return len<0;
+      if((long)(millis()-deadline)>=0) return false;
+      delay(0);
+      continue;
+    }
+    if(len>0 && n>len) n = len;
+    if(pos<maxlen-1) {
+      if(n>maxlen-1-pos) n = maxlen-1-pos;
+      n = client.read((uint8_t*)resp+pos, n);
+      if(n>0) pos += n;
+    } else {
+      if(n>(int)sizeof(dump)) n = sizeof(dump);
+      n = client.read((uint8_t*)dump, n);
+    }
+    if(n>0 && len>0) len -= n;
+  }
+  return true;
+}
+
+/** Issue one request over the slot's connection, with host in the Host header
+ * Returns the HTTP status code, -1 if no response arrived at all,
+ * or 0 if the response was broken
+ */
+static int connpool_request(PooledConn *c, const char *host, const char *path, char *resp, int maxlen) {
+  char req[TMP_BUFFER_SIZE+128];
+  char port[7] = "";
+  if(c->port!=80) snprintf(port, sizeof(port), ":%u", c->port);
+  snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: %s%s\r\nConnection: keep-alive\r\n\r\n",
+           path, host, port);
+  c->client.write((uint8_t*)req, strlen(req));
+
+  ulong deadline = millis() + CONNPOOL_TIMEOUT_MS;
+  char *line = req; // the request has been sent, reuse its buffer
+  if(connpool_readline(c->client, line, sizeof(req), deadline)<0) return -1;
+  if(strncmp(line, "HTTP/1.", 7)) return 0;
+  int code = atoi(line+9);
+  bool keepalive = (line[7]=='1');  // HTTP/1.1 defaults to keep-alive
+  bool chunked = false;
+  long clen = -1;
+
+  // parse response headers
+  int n;
+  while((n=connpool_readline(c->client, line, sizeof(req), deadline))>0) {
+    char *v = strchr(line, ':');
+    if(!v) continue;
+    *v++ = 0;
+    while(*v==' ') v++;
+    if(!strcasecmp(line, "Content-Length")) {
+      clen = atol(v);
+    } else if(!strcasecmp(line, "Connection")) {
+      keepalive = strncasecmp(v, "close", 5)!=0;
+    } else if(!strcasecmp(line, "Transfer-Encoding")) {
+      chunked = strncasecmp(v, "chunked", 7)==0;
+    }
+  }
+  if(n<0) return 0;
+
+  // read response body
+  int pos=0;
+  bool ok=true;
+  if(chunked) {
+    while(ok) {
+      if(connpool_readline(c->client, line, sizeof(req), deadline)<0) { ok=false; break; }
+      long size = strtol(line, NULL, 16);
+      if(size<=0) {
+        ok = connpool_readline(c->client, line, sizeof(req), deadline)>=0; // trailing CRLF
+        break;
+      }
+      ok = connpool_readbody(c->client, size, resp, maxlen, pos, deadline) &&
+           connpool_readline(c->client, line, sizeof(req), deadline)>=0;
+    }
+  } else {
+    if(clen<0) keepalive = false;  // no length: body ends when the remote closes
+    ok = connpool_readbody(c->client, clen, resp, maxlen, pos, deadline);
+  }
+  resp[pos]=0;
+  if(!ok) return 0;
+  if(!keepalive) c->client.stop();
+  return code;
+}
+
+/** Send a HTTP GET request to a remote host:port
+ * host is a server name or an ip address. It is sent in the Host header,
+ * so that name based virtual hosts work, and resolved only when a new
+ * connection is opened: the address is kept with the slot until a
+ * request fails. The connection is kept open for the next request to
+ * the same remote.
+ * The response body is copied into resp (up to maxlen-1 bytes).
+ * Returns the HTTP status code, or 0 on failure.
+ */
+int connpool_get(const char *host, uint16_t port, const char *path, char *resp, int maxlen) {
+  PooledConn *c = connpool_slot(host, port);
+  resp[0]=0;
+
+  int code = 0;
+  for(byte attempt=0;attempt<2;attempt++) {
+    bool reused = c->client.connected();
+    if(!reused) {
+      c->client.stop();
+      if(!(uint32_t)c->ip && !WiFi.hostByName(host, c->ip)) break;
+      if(!c->client.connect(c->ip, port)) break;
+      c->client.setNoDelay(true);
+    }
+    code = connpool_request(c, host, path, resp, maxlen);
+    if(code>0) break;
+    c->client.stop();
+    // a pooled connection may have been closed by the remote in the meantime
+    // so retry once over a fresh connection
+    if(!(code<0 && reused)) break;
+  }
+  c->last_used = millis();
+  // the name is resolved again next time, in case the remote has moved
+  if(code<=0) c->ip = IPAddress();
+  return code>0 ? code : 0;
+}
+
+/** Close pooled connections that are idle or closed by the remote */
+void connpool_expire() {
+  ulong curr = millis();
+  for(PooledConn *c=pool;c<pool+CONNPOOL_SIZE;c++) {
+    if(c->client.connected() && curr-c->last_used<CONNPOOL_IDLE_MS) continue;
+    c->client.stop();
+  }
+}
+
+/** Close all pooled connections */
+void connpool_close_all() {
+  for(PooledConn *c=pool;c<pool+CONNPOOL_SIZE;c++) {
+    c->client.stop();
+    c->host[0] = 0;
+    c->port = 0;
+    c->ip = IPAddress();
+  }
+}
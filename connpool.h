@@ -0,0 +1,46 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Keep-alive HTTP connection pool header file
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CONNPOOL_H
+#define _CONNPOOL_H
+
+#include <ESP8266WiFi.h>
+#include "defines.h"
+
+#define CONNPOOL_SIZE          4      // number of remote host:port slots kept in the pool
+#define CONNPOOL_HOST_SIZE     64     // longest remote name kept in a slot (longer ones are not pooled)
+#define CONNPOOL_IDLE_MS       15000  // close pooled connections idle for longer than this
+#define CONNPOOL_TIMEOUT_MS    5000   // response timeout
+
+/** Pooled outgoing HTTP/1.1 connection, keyed by remote host:port */
+struct PooledConn {
+  WiFiClient client;
+  char host[CONNPOOL_HOST_SIZE];  // remote name or ip as given (empty: the slot is unused)
+  uint16_t port;        // remote port
+  IPAddress ip;         // address the name resolved to (0: not resolved yet)
+  ulong last_used;      // time (millis) of the most recent request
+};
+
+int  connpool_get(const char *host, uint16_t port, const char *path, char *resp, int maxlen);
+void connpool_expire();     // close idle and dead connections
+void connpool_close_all();  // close all pooled connections
+
+#endif  // _CONNPOOL_H
@@ -53,6 +53,7 @@ typedef unsigned long ulong;
 #define STATION_ATTR_FILENAME "stns.dat"      // station attributes data file
 #define WIFI_FILENAME         "wifi.dat"      // wifi credentials file
 #define IFTTT_KEY_FILENAME    "ifkey.txt"
+#define RELAY_TRACE_FILENAME  "trace.txt"     // relay actuation trace dump file
 #define IFTTT_KEY_MAXSIZE     128
 #define STATION_SPECIAL_DATA_SIZE  (TMP_BUFFER_SIZE - 8)
 
@@ -66,6 +67,19 @@ typedef unsigned long ulong;
 #define STN_TYPE_HTTP        0x04	// Support for HTTP Get connection
 #define STN_TYPE_OTHER       0xFF
 
+// longest RF pulse (in us): the sync gap of a code is 31 pulses long, in timer1 ticks
+// (5 per us) it has to fit the timer's 23-bit count
+#define RF_MAX_PULSE_US      54120
+
+/** Data generations (bumped whenever the data changes, used for ETags) */
+#define DATA_GEN_PROGRAMS    0
+#define DATA_GEN_STATIONS    1   // station names and attributes
+#define DATA_GEN_OPTIONS     2
+#define NUM_DATA_GENS        3
+
+#define SPE_REFRESH_INTERVAL     MAX_NUM_STATIONS  // special station auto refresh interval (seconds)
+#define SPE_REFRESH_MAX_BACKOFF  3   // failed refreshes back off up to 2^3 times the interval
+
 #define IFTTT_PROGRAM_SCHED   0x01
 #define IFTTT_RAINSENSOR      0x02
 #define IFTTT_FLOWSENSOR      0x04
@@ -222,7 +236,14 @@ typedef enum {
     #define OS_HW_VERSION    (OS_HW_VERSION_BASE+30)
 
     #define PIN_CURR_SENSE    A0
-    #define PIN_FREE_LIST     {} // free GPIO pin for relays
+    // GPIO pins GPIO stations may use (a pin is refused while a relay of another station is on it)
+    // GPIO0 and GPIO15 (boot mode straps: a relay on them can keep the board from booting) and
+    // GPIO3 (serial RXD) are only offered if GPIO_STATIONS_ON_BOOT_PINS is defined
+    #if defined(GPIO_STATIONS_ON_BOOT_PINS)
+    #define PIN_FREE_LIST     {4,5,12,13,14,16,0,3,15}
+    #else
+    #define PIN_FREE_LIST     {4,5,12,13,14,16}
+    #endif
     #define ETHER_BUFFER_SIZE   4096
 
     extern byte PIN_BUTTON_1;
@@ -234,6 +255,9 @@ typedef enum {
     extern byte PIN_RELAY_3;
     extern byte PIN_RELAY_4;
     extern byte PIN_RELAY_5;
+    extern byte PIN_RELAY_6;
+    extern byte PIN_RELAY_7;
+    extern byte PIN_RELAY_8;
     extern byte PIN_LED;
     extern byte PIN_RFRX;
     extern byte PIN_RFTX;
@@ -245,6 +269,8 @@ typedef enum {
     extern byte PIN_RAINSENSOR;
     extern byte PIN_FLOWSENSOR;
 
+  // per-route web server metrics at /jm: about 64 bytes of RAM per route (2-3 KB), so off by default
+  //#define ENABLE_SERVER_METRICS
   #define ENABLE_DEBUG
   #if defined(ENABLE_DEBUG)
       #define DEBUG_BEGIN(x)   Serial.begin(x)
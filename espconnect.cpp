@@ -22,30 +22,29 @@
 
 const char html_ap_redirect[] PROGMEM = "<h3>WiFi config saved. Now switching to station mode.</h3>";
 
-String scan_network() {
-  WiFi.mode(WIFI_STA);
-  WiFi.disconnect();
-  byte n = WiFi.scanNetworks();
-  String wirelessinfo;
-  if (n>32) n = 32; // limit to 32 ssids max
-   //Maintain old format of wireless network JSON for mobile app compat
-   wirelessinfo = "{\"ssids\":["; 
-  for(int i=0;i<n;i++) {
-    wirelessinfo += "\"";
-    wirelessinfo += WiFi.SSID(i);
-    wirelessinfo += "\"";
-    if(i<n-1) wirelessinfo += ",\r\n";
-  }
-  wirelessinfo += "],";
-  wirelessinfo += "\"rssis\":["; 
+/** Start a scan for networks in the background
+ * The STA interface must be up (AP_STA mode); the AP stays up during the scan.
+ */
+void scan_network_start() {
+  WiFi.scanNetworks(true);
+}
+
+/** Collect the results of a background scan
+ * Returns -1 while the scan is running, otherwise the number of
+ * networks (up to max_results) stored in results.
+ */
+int scan_network_done(ScanResult *results, byte max_results) {
+  int n = WiFi.scanComplete();
+  if (n==WIFI_SCAN_RUNNING) return -1;
+  if (n<0) n = 0;  // failed
+  if (n>max_results) n = max_results;
   for(int i=0;i<n;i++) {
-    wirelessinfo += "\"";
-    wirelessinfo += WiFi.RSSI(i);
-    wirelessinfo += "\"";
-    if(i<n-1) wirelessinfo += ",\r\n";
+    strncpy(results[i].ssid, WiFi.SSID(i).c_str(), sizeof(results[i].ssid)-1);
+    results[i].ssid[sizeof(results[i].ssid)-1] = 0;
+    results[i].rssi = WiFi.RSSI(i);
   }
-  wirelessinfo += "]}";
-  return wirelessinfo;
+  WiFi.scanDelete();
+  return n;
 }
 
 void start_network_ap(const char *ssid, const char *pass) {
@@ -39,9 +39,18 @@
 #include <WiFiUdp.h>
 #include "time.h"
 #include "defines.h"
-#include "htmls.h"
+#include "htmls_gz.h"  // generated from htmls.h by make_htmls_gz.py
 
-String scan_network();
+#define MAX_SCAN_RESULTS 32  // networks kept from a scan
+
+/** A network found by scan_network */
+struct ScanResult {
+  char ssid[33];  // up to 32 characters and the terminating 0
+  int8_t rssi;
+};
+
+void scan_network_start();
+int scan_network_done(ScanResult *results, byte max_results);
 void start_network_ap(const char *ssid, const char *pass);
 void start_network_sta(const char *ssid, const char *pass);
 void start_network_sta_with_ap(const char *ssid, const char *pass);
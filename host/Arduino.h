@@ -0,0 +1,189 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: stand-in for the ESP8266 Arduino core
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// flash and RAM share one address space on the host
+#define PROGMEM
+#define ICACHE_RAM_ATTR
+#define PGM_P const char*
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcat_P strcat
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define HIGH 1
+#define LOW 0
+#define FALLING 2
+#define A0 17
+#define HEX 16
+#define DEC 10
+
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void yield();
+void attachInterrupt(uint8_t, void(*)(), int);
+uint32_t ESP_getCycleCount();
+char* itoa(int, char*, int);
+char* ltoa(long, char*, int);
+char* ultoa(unsigned long, char*, int);
+char* dtostrf(double, signed char, unsigned char, char*);
+
+/** Arduino String on top of std::string
+ * Like the core's String, every object that outgrows its
+ * inline storage allocates on the heap.
+ */
+class String {
+public:
+  std::string s;
+  String() {}
+  String(const char* c) : s(c?c:"") {}
+  String(const __FlashStringHelper* c) : s((const char*)c) {}
+  String(char c) : s(1, c) {}
+  String(unsigned char v) : s(std::to_string(v)) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(unsigned char o) { s += std::to_string(o); return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned o) { s += std::to_string(o); return *this; }
+  String& operator+=(long o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned long o) { s += std::to_string(o); return *this; }
+  String& operator+=(const __FlashStringHelper* o) { s += (const char*)o; return *this; }
+  friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+  friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  unsigned length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  long toInt() const { return atol(s.c_str()); }
+  void trim() {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if(b==std::string::npos) { s.clear(); return; }
+    s = s.substr(b, s.find_last_not_of(" \t\r\n")-b+1);
+  }
+  void remove(unsigned i) { if(i<s.size()) s.erase(i); }
+  bool reserve(unsigned n) { s.reserve(n); return true; }
+  char operator[](unsigned i) const { return i<s.size() ? s[i] : 0; }
+};
+
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  template<class T> size_t print(T) { return 0; }
+  template<class T> size_t print(T, int) { return 0; }
+  template<class T> size_t println(T) { return 0; }
+  template<class T> size_t println(T, int) { return 0; }
+  size_t println() { return 0; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  void restart();
+  uint32_t getFreeSketchSpace();
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  uint32_t getCycleCount();
+};
+extern EspClass ESP;
+
+#define UPDATE_ERROR_MD5        (7)
+#define UPDATE_ERROR_MAGIC_BYTE (10)
+
+class UpdaterClass {
+public:
+  bool begin(size_t);
+  size_t write(uint8_t*, size_t);
+  bool end(bool evenIfRemaining=false);
+  bool hasError();
+  size_t progress();
+  size_t size();
+  size_t remaining();
+  bool isRunning();
+  void printError(HardwareSerial&);
+  bool setMD5(const char*);
+  String md5String();
+  uint8_t getError();
+};
+extern UpdaterClass Update;
+
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_LEVEL 1
+#define TIM_SINGLE 0
+#define TIM_LOOP 1
+typedef void(*timercallback)(void);
+void timer1_attachInterrupt(timercallback);
+void timer1_detachInterrupt();
+void timer1_enable(uint8_t, uint8_t, uint8_t);
+void timer1_disable();
+void timer1_write(uint32_t);
+void noInterrupts();
+void interrupts();
+void configTime(int, int, const char*, const char*, const char*);
+
+extern volatile uint32_t GPOS, GPOC;
+#define RANDOM_REG32 ((uint32_t)rand())
+
+#include "../TimeLib.h"
+
+#endif  // _HOST_ARDUINO_H
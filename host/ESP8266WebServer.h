@@ -0,0 +1,129 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: stand-in for ESP8266WebServer (core 2.4 interface)
+ * Requests are injected with hostRequest() instead of being read
+ * from a socket, and the response bytes are captured in a HostConn.
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_ESP8266WEBSERVER_H
+#define _HOST_ESP8266WEBSERVER_H
+
+#include <functional>
+#include <vector>
+#include "ESP8266WiFi.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+#define HTTP_UPLOAD_BUFLEN 2048
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+class ESP8266WebServer;
+
+class RequestHandler {
+public:
+  virtual ~RequestHandler() {}
+  virtual bool canHandle(HTTPMethod method, String uri) { return false; }
+  virtual bool canUpload(String uri) { return false; }
+  virtual bool handle(ESP8266WebServer& server, HTTPMethod requestMethod, String requestUri) { return false; }
+  virtual void upload(ESP8266WebServer& server, String requestUri, HTTPUpload& upload) {}
+  RequestHandler* next() { return _next; }
+  void next(RequestHandler* r) { _next = r; }
+private:
+  RequestHandler* _next = nullptr;
+};
+
+class ESP8266WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+  ESP8266WebServer(int port=80) : _port(port) {}
+  ~ESP8266WebServer();
+  void begin() {}
+  void handleClient() {}
+  void close() {}
+  void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn) { on(uri, method, fn, THandlerFunction()); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn);
+  void addHandler(RequestHandler* handler) { _handlers.push_back(handler); }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  String uri() { return _uri; }
+  HTTPMethod method() { return _method; }
+  WiFiClient client() { return WiFiClient(_conn); }
+  HTTPUpload& upload() { return _upload; }
+  String arg(String name);
+  String arg(int i);
+  String argName(int i);
+  int args() { return (int)_args.size(); }
+  bool hasArg(String name);
+  void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+  String header(String name);
+  bool hasHeader(String name);
+  void send(int code, const char* content_type = NULL, const String& content = String(""));
+  void send(int code, const String& content_type, const String& content) { send(code, content_type.c_str(), content); }
+  void send_P(int code, PGM_P content_type, PGM_P content) { send_P(code, content_type, content, strlen_P(content)); }
+  void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+  void setContentLength(const size_t contentLength) { _contentLength = contentLength; }
+  bool chunkedResponseModeStart(int code, const char* content_type);
+  void chunkedResponseFinalize() { sendContent(String("")); }
+  void keepAlive(bool) {}
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void sendContent(const String& content) { sendContent_P(content.c_str(), content.length()); }
+  void sendContent_P(PGM_P content) { sendContent_P(content, strlen_P(content)); }
+  void sendContent_P(PGM_P content, size_t size);
+
+  /** Host build: dispatch one request on conn like handleClient() would
+   * query is the part of the URL after '?' (may be NULL), body the POST body
+   * (passed to the handlers as the "plain" argument). Request headers are
+   * set with hostHeader() beforehand and cleared by the request.
+   */
+  void hostRequest(HostConn *conn, HTTPMethod method, const char *uri, const char *query, const char *body=NULL);
+  void hostHeader(const char *name, const char *value);
+
+private:
+  typedef std::pair<std::string, std::string> KeyValue;
+
+  void prepareHeader(std::string &out, int code, const char *content_type, size_t length);
+
+  int _port;
+  std::vector<RequestHandler*> _handlers;
+  THandlerFunction _notFound;
+  std::vector<KeyValue> _args;
+  std::vector<KeyValue> _headers;  // collected headers, value set per request
+  std::vector<KeyValue> _requestHeaders;
+  std::string _responseHeaders;
+  String _uri;
+  HTTPMethod _method = HTTP_ANY;
+  HostConn *_conn = NULL;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  bool _chunked = false;
+  HTTPUpload _upload;
+};
+
+#endif  // _HOST_ESP8266WEBSERVER_H
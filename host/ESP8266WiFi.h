@@ -0,0 +1,139 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: stand-in for the ESP8266 WiFi library
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_ESP8266WIFI_H
+#define _HOST_ESP8266WIFI_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  uint8_t b[4];
+  IPAddress() : b{0,0,0,0} {}
+  IPAddress(uint8_t a, uint8_t c, uint8_t d, uint8_t e) : b{a,c,d,e} {}
+  IPAddress(uint32_t v) { memcpy(b,&v,4); }
+  IPAddress(const uint8_t* p) { memcpy(b,p,4); }
+  operator uint32_t() const { uint32_t v; memcpy(&v,b,4); return v; }
+  bool operator==(uint32_t v) const { return (uint32_t)*this==v; }
+  bool operator==(const IPAddress& o) const { return (uint32_t)*this==(uint32_t)o; }
+  uint8_t operator[](int i) const { return b[i]; }
+};
+
+/** Captured server side connection
+ * Everything written to it ends up in out. Like the core's ClientContext
+ * it is reference counted, so the web server can tell whether a handler
+ * kept the client to respond later.
+ */
+struct HostConn {
+  std::string out;
+  bool open;
+  int refs;
+  IPAddress remote;
+};
+
+/** Client connection
+ * Server side clients write into a HostConn, outgoing connections
+ * always fail (the host build has no network).
+ */
+class WiFiClient {
+  HostConn *_conn;
+  void unref() { if(_conn) _conn->refs--; }
+public:
+  WiFiClient() : _conn(NULL) {}
+  explicit WiFiClient(HostConn *conn) : _conn(conn) { if(_conn) _conn->refs++; }
+  WiFiClient(const WiFiClient &o) : _conn(o._conn) { if(_conn) _conn->refs++; }
+  WiFiClient& operator=(const WiFiClient &o) {
+    if(o._conn) o._conn->refs++;
+    unref();
+    _conn = o._conn;
+    return *this;
+  }
+  ~WiFiClient() { unref(); }
+  int connect(IPAddress, uint16_t);
+  int connect(const char*, uint16_t);
+  size_t write(const uint8_t*, size_t);
+  size_t write(const char*);
+  size_t write_P(PGM_P, size_t);
+  int available();
+  int read();
+  int read(uint8_t*, size_t);
+  int peek();
+  void stop();
+  void flush();
+  uint8_t connected();
+  operator bool();
+  void setNoDelay(bool);
+  void setTimeout(unsigned long);
+  IPAddress remoteIP();
+  uint16_t remotePort();
+  IPAddress localIP();
+  uint16_t localPort();
+  size_t availableForWrite();
+  String readStringUntil(char);
+  template<class T> size_t print(T v) { String s(v); return write((const uint8_t*)s.c_str(), s.length()); }
+  template<class T> size_t println(T v) { return print(v)+write("\r\n"); }
+  static void stopAll();
+};
+
+class WiFiServer {
+public:
+  WiFiServer(uint16_t);
+  void begin();
+  WiFiClient available();
+  void setNoDelay(bool);
+  bool hasClient();
+};
+
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WIFI_AP_STA 3
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class ESP8266WiFiClass {
+public:
+  void mode(int);
+  void disconnect();
+  int8_t scanNetworks(bool async=false, bool show_hidden=false);
+  int8_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t);
+  String SSID();
+  int32_t RSSI(uint8_t);
+  int32_t RSSI();
+  uint8_t encryptionType(uint8_t);
+  void softAP(const char*);
+  void softAP(const char*, const char*);
+  int begin(const char*, const char*);
+  int status();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress softAPIP();
+  uint8_t* macAddress(uint8_t*);
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress);
+  void persistent(bool);
+  int hostByName(const char*, IPAddress&);
+};
+extern ESP8266WiFiClass WiFi;
+
+#endif  // _HOST_ESP8266WIFI_H
@@ -0,0 +1,89 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: in-memory stand-in for SPIFFS
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_FS_H
+#define _HOST_FS_H
+
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+
+enum SeekMode { SeekSet=0, SeekCur=1, SeekEnd=2 };
+
+/** Open file
+ * Copies of a File share the position, as with the core's FileImpl.
+ */
+struct HostOpenFile {
+  std::shared_ptr<std::string> data;
+  size_t pos;
+  char name[32];
+};
+
+class File {
+  std::shared_ptr<HostOpenFile> _f;
+public:
+  File() {}
+  explicit File(std::shared_ptr<HostOpenFile> f) : _f(f) {}
+  operator bool() const { return (bool)_f; }
+  int read();
+  size_t read(uint8_t*, size_t);
+  size_t write(const uint8_t*, size_t);
+  size_t write(uint8_t);
+  bool seek(uint32_t, SeekMode=SeekSet);
+  size_t position() const { return _f ? _f->pos : 0; }
+  size_t size() const { return _f ? _f->data->size() : 0; }
+  int available() { return (int)(size()-position()); }
+  void close() { _f.reset(); }
+  void flush() {}
+  String readStringUntil(char);
+  template<class T> size_t print(T v) { String s(v); return write((const uint8_t*)s.c_str(), s.length()); }
+  template<class T> size_t println(T v) { return print(v)+write((const uint8_t*)"\r\n", 2); }
+  const char* name() const { return _f ? _f->name : ""; }
+};
+
+/** Snapshot of the file names that start with a prefix */
+class Dir {
+  std::shared_ptr<std::vector<std::string>> _names;
+  size_t _next;
+public:
+  Dir() : _next(0) {}
+  explicit Dir(std::shared_ptr<std::vector<std::string>> names) : _names(names), _next(0) {}
+  bool next();
+  String fileName();
+  size_t fileSize();
+  File openFile(const char*);
+};
+
+class FS {
+public:
+  bool begin();
+  bool format();
+  File open(const char*, const char*);
+  File open(const String& p, const char* m) { return open(p.c_str(), m); }
+  bool exists(const char*);
+  bool exists(const String& p) { return exists(p.c_str()); }
+  bool remove(const char*);
+  bool remove(const String& p) { return remove(p.c_str()); }
+  Dir openDir(const char*);
+};
+extern FS SPIFFS;
+
+#endif  // _HOST_FS_H
@@ -0,0 +1,290 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: HTTP handler benchmark
+ * Replays recorded requests against the firmware's URL handlers and
+ * reports requests per second and allocations per request.
+ *
+ * Usage: osbench [-n nvm.dat] [-s setup.txt] [-r rounds] [-d dump.txt] corpus.txt...
+ *
+ * -n  start from a NVM image saved from a controller
+ *     (by default the factory defaults are written)
+ * -s  requests replayed once, untimed, to prepare the controller
+ * -r  number of times each corpus is replayed (default 100)
+ * -d  write the responses of the first round to a file, so the
+ *     output of two builds can be compared
+ *
+ * A corpus has one request per line: an optional method (GET or POST),
+ * the path with its query string, and for POST a tab followed by the
+ * body. Empty lines and lines starting with # are skipped.
+ * A line starting with "changed " revalidates: the ETag of the last
+ * response to the same path is sent as If-None-Match, and the request
+ * fails unless the data changed in between (a 200 with a new ETag).
+ * A response that repeats a header (one left over from an earlier
+ * request, say) counts as failed.
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "../OpenSprinkler.h"
+#include "../program.h"
+
+extern OpenSprinkler os;
+extern ProgramData pd;
+extern ESP8266WebServer *wifi_server;
+
+void do_setup();
+void start_server_client();
+void server_job_loop();
+void write_log(byte type, ulong curr_time);
+
+#define BENCH_EPOCH     1546300800UL  // 2019-01-01 00:00 UTC, the corpora's log times are around it
+#define BENCH_LOG_DAYS  30            // days of station logs written before the replay
+#define BENCH_LOG_RUNS  24            // station runs logged per day
+#define BENCH_MAX_LOOPS 100000        // job loop iterations before a response is given up
+
+struct BenchRequest {
+  HTTPMethod method;
+  std::string path;
+  std::string query;
+  std::string body;
+  bool has_body;
+  bool changed;     // must not be answered from the client's copy
+};
+
+struct BenchResult {
+  unsigned long requests;
+  unsigned long failed;     // responses other than 200, or responses that never completed
+  unsigned long allocs;
+  unsigned long alloc_bytes;
+  unsigned long long resp_bytes;
+  double seconds;
+};
+
+static HostConn conn;
+static std::map<std::string, std::string> etags;  // last ETag per path
+
+static double bench_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static bool bench_load(const char *fn, std::vector<BenchRequest> &reqs) {
+  FILE *fp = fopen(fn, "r");
+  if(!fp) return false;
+  char line[4096];
+  while(fgets(line, sizeof(line), fp)) {
+    line[strcspn(line, "\r\n")] = 0;
+    if(!line[0] || line[0]=='#') continue;
+    BenchRequest r;
+    char *p = line;
+    r.method = HTTP_GET;
+    r.changed = !strncmp(p, "changed ", 8);
+    if(r.changed) p += 8;
+    if(!strncmp(p, "GET ", 4)) p += 4;
+    else if(!strncmp(p, "POST ", 5)) { r.method = HTTP_POST; p += 5; }
+    char *tab = strchr(p, '\t');
+    r.has_body = tab!=NULL;
+    if(tab) { *tab = 0; r.body = tab+1; }
+    char *q = strchr(p, '?');
+    if(q) { *q = 0; r.query = q+1; }
+    r.path = p;
+    reqs.push_back(r);
+  }
+  fclose(fp);
+  return true;
+}
+
+/** Value of a response header in conn.out, or an empty string */
+static std::string bench_header(const char *name) {
+  size_t end = conn.out.find("\r\n\r\n");
+  size_t len = strlen(name);
+  for(size_t p=conn.out.find("\r\n");p<end;) {
+    p += 2;
+    size_t e = conn.out.find("\r\n", p);
+    if(!strncasecmp(conn.out.c_str()+p, name, len) && conn.out[p+len]==':') {
+      p += len+1;
+      while(conn.out[p]==' ') p++;
+      return conn.out.substr(p, e-p);
+    }
+    p = e;
+  }
+  return std::string();
+}
+
+/** Check that no header appears twice in the response in conn.out */
+static bool bench_unique_headers(const BenchRequest &r) {
+  size_t end = conn.out.find("\r\n\r\n");
+  std::vector<std::string> names;
+  for(size_t p=conn.out.find("\r\n");p<end;) {
+    p += 2;
+    size_t e = conn.out.find("\r\n", p);
+    std::string name = conn.out.substr(p, conn.out.find(':', p)-p);
+    for(size_t i=0;i<name.size();i++) name[i] = tolower(name[i]);
+    for(size_t i=0;i<names.size();i++) {
+      if(names[i]==name) {
+        fprintf(stderr, "%s: repeated header %s\n", r.path.c_str(), name.c_str());
+        return false;
+      }
+    }
+    names.push_back(name);
+    p = e;
+  }
+  return true;
+}
+
+/** Run one request to completion, including the jobs it started
+ * Returns the HTTP status code, or 0 if the response did not complete
+ * (or if it repeats a header, or, for a "changed" request, if it was
+ * answered with the old ETag)
+ */
+static int bench_request(const BenchRequest &r) {
+  std::string old;
+  {
+    HostQuiet quiet;  // the bench's own allocations are not counted
+    conn.out.clear();
+    conn.refs = 0;
+    old = etags[r.path];
+    if(r.changed && !old.empty()) wifi_server->hostHeader("If-None-Match", old.c_str());
+  }
+  // a second between requests keeps the rate limits and the HTTP budget from throttling the replay
+  host_advance(1000);
+  wifi_server->hostRequest(&conn, r.method, r.path.c_str(), r.query.c_str(), r.has_body ? r.body.c_str() : NULL);
+  for(long i=0;conn.open;i++) {
+    if(i==BENCH_MAX_LOOPS) return 0;
+    server_job_loop();
+    host_advance(1000);
+  }
+  HostQuiet quiet;
+  if(conn.out.compare(0, 9, "HTTP/1.1 ") || !bench_unique_headers(r)) return 0;
+  std::string &etag = etags[r.path];
+  etag = bench_header("ETag");
+  if(r.changed && (etag.empty() || etag==old)) return 0;
+  return atoi(conn.out.c_str()+9);
+}
+
+static void bench_prepare_logs() {
+  ulong day = BENCH_EPOCH/86400;
+  for(ulong d=day-BENCH_LOG_DAYS+1;d<=day;d++) {
+    for(byte i=0;i<BENCH_LOG_RUNS;i++) {
+      pd.lastrun.station = i%os.nstations;
+      pd.lastrun.program = i%4+1;
+      pd.lastrun.duration = 300+i*15;
+      write_log(LOGDATA_STATION, d*86400+i*3600+pd.lastrun.duration);
+    }
+    write_log(LOGDATA_RAINDELAY, d*86400+43200);
+    write_log(LOGDATA_WATERLEVEL, d*86400+64800);
+  }
+}
+
+static void bench_run(const char *name, const std::vector<BenchRequest> &reqs, int rounds, FILE *dump, BenchResult &res) {
+  memset(&res, 0, sizeof(res));
+  for(int k=0;k<rounds;k++) {
+    for(size_t i=0;i<reqs.size();i++) {
+      host_allocs = 0;
+      host_alloc_bytes = 0;
+      double t0 = bench_seconds();
+      int code = bench_request(reqs[i]);
+      res.seconds += bench_seconds()-t0;
+      res.requests++;
+      if(code!=200) res.failed++;
+      res.allocs += host_allocs;
+      res.alloc_bytes += host_alloc_bytes;
+      res.resp_bytes += conn.out.size();
+      if(dump && !k) {
+        fprintf(dump, "### %s %s?%s\n", name, reqs[i].path.c_str(), reqs[i].query.c_str());
+        fwrite(conn.out.data(), 1, conn.out.size(), dump);
+        fputs("\n", dump);
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const char *nvm_image = NULL, *setup = NULL, *dump_file = NULL;
+  int rounds = 100;
+  int opt;
+  while((opt=getopt(argc, argv, "n:s:r:d:"))!=-1) {
+    switch(opt) {
+      case 'n': nvm_image = optarg; break;
+      case 's': setup = optarg; break;
+      case 'r': rounds = atoi(optarg); break;
+      case 'd': dump_file = optarg; break;
+      default:
+        fprintf(stderr, "usage: %s [-n nvm.dat] [-s setup.txt] [-r rounds] [-d dump.txt] corpus.txt...\n", argv[0]);
+        return 1;
+    }
+  }
+  if(optind>=argc || rounds<1) {
+    fprintf(stderr, "no corpus given\n");
+    return 1;
+  }
+
+  if(nvm_image && !host_flash_load(NVM_FILENAME, nvm_image)) {
+    fprintf(stderr, "cannot read %s\n", nvm_image);
+    return 1;
+  }
+  setTime(BENCH_EPOCH);
+  do_setup();
+  start_server_client();
+  bench_prepare_logs();
+
+  if(setup) {
+    std::vector<BenchRequest> reqs;
+    if(!bench_load(setup, reqs)) {
+      fprintf(stderr, "cannot read %s\n", setup);
+      return 1;
+    }
+    for(size_t i=0;i<reqs.size();i++) {
+      if(bench_request(reqs[i])!=200) fprintf(stderr, "setup request %u failed\n", (unsigned)i+1);
+    }
+  }
+
+  FILE *dump = NULL;
+  if(dump_file && !(dump=fopen(dump_file, "w"))) {
+    fprintf(stderr, "cannot write %s\n", dump_file);
+    return 1;
+  }
+
+  int ret = 0;
+  printf("%-16s %8s %10s %12s %12s %12s %6s\n", "corpus", "requests", "req/s", "allocs/req", "alloc B/req", "resp B/req", "failed");
+  for(int i=optind;i<argc;i++) {
+    std::vector<BenchRequest> reqs;
+    if(!bench_load(argv[i], reqs) || reqs.empty()) {
+      fprintf(stderr, "cannot read %s\n", argv[i]);
+      ret = 1;
+      continue;
+    }
+    const char *name = strrchr(argv[i], '/');
+    name = name ? name+1 : argv[i];
+    BenchResult res;
+    bench_run(name, reqs, rounds, dump, res);
+    printf("%-16s %8lu %10.0f %12.1f %12.1f %12.1f %6lu\n", name, res.requests,
+           res.seconds>0 ? res.requests/res.seconds : 0.0,
+           (double)res.allocs/res.requests, (double)res.alloc_bytes/res.requests,
+           (double)res.resp_bytes/res.requests, res.failed);
+    if(res.failed) ret = 1;
+  }
+  if(dump) fclose(dump);
+  return ret;
+}
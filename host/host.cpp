@@ -0,0 +1,607 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: implementation of the stand-in core
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <new>
+#include <time.h>
+#include "host.h"
+#include "FS.h"
+#include "ESP8266WebServer.h"
+
+int host_quiet = 0;
+unsigned long host_allocs = 0;
+unsigned long host_alloc_bytes = 0;
+
+HardwareSerial Serial;
+EspClass ESP;
+UpdaterClass Update;
+ESP8266WiFiClass WiFi;
+FS SPIFFS;
+volatile uint32_t GPOS, GPOC;
+
+// ======================
+// Allocation counting
+// ======================
+// the replacements pair malloc with free, which newer compilers flag once
+// they are inlined into each other
+#if defined(__GNUC__) && (__GNUC__>=11)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t n) {
+  if(!host_quiet) {
+    host_allocs++;
+    host_alloc_bytes += n;
+  }
+  void *p = malloc(n ? n : 1);
+  if(!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// ======================
+// Clock
+// ======================
+static unsigned long long host_skip_us = 0;
+
+static unsigned long long host_clock_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec*1000000ULL + ts.tv_nsec/1000 + host_skip_us;
+}
+
+void host_advance(unsigned long ms) { host_skip_us += (unsigned long long)ms*1000ULL; }
+
+unsigned long millis() { return (unsigned long)(host_clock_us()/1000ULL); }
+unsigned long micros() { return (unsigned long)host_clock_us(); }
+void delay(unsigned long ms) { host_advance(ms); }
+void delayMicroseconds(unsigned int us) { host_skip_us += us; }
+void yield() {}
+uint32_t ESP_getCycleCount() { return (uint32_t)(host_clock_us()*80); }
+
+// ======================
+// Pins, timers and interrupts
+// ======================
+static uint8_t pin_values[32];
+static bool pins_ready = false;
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if(pin<sizeof(pin_values)) pin_values[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+  // inputs idle high (buttons are active low)
+  if(!pins_ready) { memset(pin_values, HIGH, sizeof(pin_values)); pins_ready = true; }
+  return pin<sizeof(pin_values) ? pin_values[pin] : HIGH;
+}
+
+void attachInterrupt(uint8_t, void(*)(), int) {}
+void timer1_attachInterrupt(timercallback) {}
+void timer1_detachInterrupt() {}
+void timer1_enable(uint8_t, uint8_t, uint8_t) {}
+void timer1_disable() {}
+void timer1_write(uint32_t) {}
+void noInterrupts() {}
+void interrupts() {}
+void configTime(int, int, const char*, const char*, const char*) {}
+
+// ======================
+// Number conversion
+// ======================
+static char* host_utoa(unsigned long v, char *buf, int base, bool neg) {
+  char tmp[34];
+  int n = 0;
+  do {
+    int d = v%base;
+    tmp[n++] = d<10 ? '0'+d : 'a'+d-10;
+    v /= base;
+  } while(v);
+  char *p = buf;
+  if(neg) *p++ = '-';
+  while(n) *p++ = tmp[--n];
+  *p = 0;
+  return buf;
+}
+
+char* itoa(int v, char *buf, int base) { return ltoa(v, buf, base); }
+
+char* ltoa(long v, char *buf, int base) {
+  if(v<0 && base==10) return host_utoa(-(unsigned long)v, buf, base, true);
+  return host_utoa((unsigned long)v, buf, base, false);
+}
+
+char* ultoa(unsigned long v, char *buf, int base) { return host_utoa(v, buf, base, false); }
+
+char* dtostrf(double v, signed char width, unsigned char prec, char *buf) {
+  sprintf(buf, "%*.*f", width, prec, v);
+  return buf;
+}
+
+// ======================
+// ESP, Update
+// ======================
+void EspClass::restart() {}
+uint32_t EspClass::getFreeSketchSpace() { return 1044464; }
+uint32_t EspClass::getFreeHeap() { return 32768; }
+uint32_t EspClass::getMaxFreeBlockSize() { return 32768; }
+uint8_t EspClass::getHeapFragmentation() { return 0; }
+
+// the 2.4 core's allocator statistics, for the same 32K free heap in one block
+extern "C" {
+#include "umm_malloc/umm_malloc.h"
+UMM_HEAP_INFO ummHeapInfo;
+void *umm_info(void *, int) {
+  ummHeapInfo.freeBlocks = ummHeapInfo.maxFreeContiguousBlocks = 32768/8;
+  return NULL;
+}
+}
+uint32_t EspClass::getCycleCount() { return ESP_getCycleCount(); }
+
+static size_t update_size, update_progress;
+static bool update_running;
+
+bool UpdaterClass::begin(size_t size) {
+  update_size = size;
+  update_progress = 0;
+  update_running = true;
+  return true;
+}
+size_t UpdaterClass::write(uint8_t*, size_t len) { update_progress += len; return len; }
+bool UpdaterClass::end(bool) { update_running = false; return true; }
+bool UpdaterClass::hasError() { return false; }
+size_t UpdaterClass::progress() { return update_progress; }
+size_t UpdaterClass::size() { return update_size; }
+size_t UpdaterClass::remaining() { return update_size-update_progress; }
+bool UpdaterClass::isRunning() { return update_running; }
+void UpdaterClass::printError(HardwareSerial&) {}
+bool UpdaterClass::setMD5(const char*) { return true; }
+String UpdaterClass::md5String() { return String(""); }
+uint8_t UpdaterClass::getError() { return 0; }
+
+// ======================
+// WiFi
+// ======================
+void ESP8266WiFiClass::mode(int) {}
+void ESP8266WiFiClass::disconnect() {}
+int8_t ESP8266WiFiClass::scanNetworks(bool, bool) { return 0; }
+int8_t ESP8266WiFiClass::scanComplete() { return 0; }
+void ESP8266WiFiClass::scanDelete() {}
+String ESP8266WiFiClass::SSID(uint8_t) { return String(""); }
+String ESP8266WiFiClass::SSID() { return String("host"); }
+int32_t ESP8266WiFiClass::RSSI(uint8_t) { return -50; }
+int32_t ESP8266WiFiClass::RSSI() { return -50; }
+uint8_t ESP8266WiFiClass::encryptionType(uint8_t) { return 0; }
+void ESP8266WiFiClass::softAP(const char*) {}
+void ESP8266WiFiClass::softAP(const char*, const char*) {}
+int ESP8266WiFiClass::begin(const char*, const char*) { return WL_CONNECTED; }
+int ESP8266WiFiClass::status() { return WL_CONNECTED; }
+IPAddress ESP8266WiFiClass::localIP() { return IPAddress(192,168,1,2); }
+IPAddress ESP8266WiFiClass::gatewayIP() { return IPAddress(192,168,1,1); }
+IPAddress ESP8266WiFiClass::softAPIP() { return IPAddress(192,168,4,1); }
+uint8_t* ESP8266WiFiClass::macAddress(uint8_t *mac) {
+  static const uint8_t host_mac[] = {0x5c,0xcf,0x7f,0x00,0x00,0x01};
+  memcpy(mac, host_mac, sizeof(host_mac));
+  return mac;
+}
+bool ESP8266WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress) { return true; }
+void ESP8266WiFiClass::persistent(bool) {}
+int ESP8266WiFiClass::hostByName(const char*, IPAddress&) { return 0; }
+
+int WiFiClient::connect(IPAddress, uint16_t) { return 0; }
+int WiFiClient::connect(const char*, uint16_t) { return 0; }
+
+size_t WiFiClient::write(const uint8_t *buf, size_t len) {
+  if(!connected()) return 0;
+  HostQuiet quiet;
+  _conn->out.append((const char*)buf, len);
+  return len;
+}
+
+size_t WiFiClient::write(const char *s) { return write((const uint8_t*)s, strlen(s)); }
+size_t WiFiClient::write_P(PGM_P buf, size_t len) { return write((const uint8_t*)buf, len); }
+int WiFiClient::available() { return 0; }
+int WiFiClient::read() { return -1; }
+int WiFiClient::read(uint8_t*, size_t) { return 0; }
+int WiFiClient::peek() { return -1; }
+// like the 2.4 core, stop() lets go of this copy; the connection is
+// closed once no copy refers to it any more
+void WiFiClient::stop() {
+  if(!_conn) return;
+  unref();
+  if(!_conn->refs) _conn->open = false;
+  _conn = NULL;
+}
+void WiFiClient::flush() {}
+uint8_t WiFiClient::connected() { return _conn && _conn->open; }
+WiFiClient::operator bool() { return connected(); }
+void WiFiClient::setNoDelay(bool) {}
+void WiFiClient::setTimeout(unsigned long) {}
+IPAddress WiFiClient::remoteIP() { return _conn ? _conn->remote : IPAddress(); }
+uint16_t WiFiClient::remotePort() { return _conn ? 49152 : 0; }
+IPAddress WiFiClient::localIP() { return WiFi.localIP(); }
+uint16_t WiFiClient::localPort() { return 80; }
+size_t WiFiClient::availableForWrite() { return connected() ? 2920 : 0; }  // default TCP send buffer
+String WiFiClient::readStringUntil(char) { return String(""); }
+void WiFiClient::stopAll() {}
+
+// ======================
+// SPIFFS
+// ======================
+typedef std::map<std::string, std::shared_ptr<std::string>> HostFlash;
+static HostFlash flash;
+
+int File::read() {
+  if(!_f || _f->pos>=_f->data->size()) return -1;
+  return (uint8_t)(*_f->data)[_f->pos++];
+}
+
+size_t File::read(uint8_t *buf, size_t len) {
+  if(!_f || _f->pos>=_f->data->size()) return 0;
+  if(len>_f->data->size()-_f->pos) len = _f->data->size()-_f->pos;
+  memcpy(buf, _f->data->data()+_f->pos, len);
+  _f->pos += len;
+  return len;
+}
+
+size_t File::write(const uint8_t *buf, size_t len) {
+  if(!_f) return 0;
+  HostQuiet quiet;
+  std::string &d = *_f->data;
+  if(d.size()<_f->pos+len) d.resize(_f->pos+len);
+  memcpy(&d[_f->pos], buf, len);
+  _f->pos += len;
+  return len;
+}
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if(!_f) return false;
+  size_t base = mode==SeekSet ? 0 : mode==SeekCur ? _f->pos : _f->data->size();
+  if(base+pos>_f->data->size()) return false;
+  _f->pos = base+pos;
+  return true;
+}
+
+String File::readStringUntil(char term) {
+  String s;
+  int c;
+  while((c=read())>=0 && c!=term) s += (char)c;
+  return s;
+}
+
+bool Dir::next() {
+  if(!_names || _next>=_names->size()) return false;
+  _next++;
+  return true;
+}
+
+String Dir::fileName() {
+  if(!_names || !_next) return String("");
+  return String((*_names)[_next-1].c_str());
+}
+
+size_t Dir::fileSize() {
+  if(!_names || !_next) return 0;
+  HostQuiet quiet;
+  HostFlash::iterator it = flash.find((*_names)[_next-1]);
+  return it==flash.end() ? 0 : it->second->size();
+}
+
+File Dir::openFile(const char *mode) {
+  if(!_names || !_next) return File();
+  return SPIFFS.open((*_names)[_next-1].c_str(), mode);
+}
+
+bool FS::begin() { return true; }
+
+bool FS::format() {
+  HostQuiet quiet;
+  flash.clear();
+  return true;
+}
+
+File FS::open(const char *path, const char *mode) {
+  HostQuiet quiet;
+  HostFlash::iterator it = flash.find(path);
+  if(it==flash.end()) {
+    if(mode[0]=='r') return File();
+    it = flash.insert(HostFlash::value_type(path, std::make_shared<std::string>())).first;
+  } else if(mode[0]=='w') {
+    it->second->clear();
+  }
+  std::shared_ptr<HostOpenFile> f = std::make_shared<HostOpenFile>();
+  f->data = it->second;
+  f->pos = mode[0]=='a' ? it->second->size() : 0;
+  strncpy(f->name, path, sizeof(f->name)-1);
+  f->name[sizeof(f->name)-1] = 0;
+  return File(f);
+}
+
+bool FS::exists(const char *path) {
+  HostQuiet quiet;
+  return flash.find(path)!=flash.end();
+}
+
+bool FS::remove(const char *path) {
+  HostQuiet quiet;
+  return flash.erase(path)>0;
+}
+
+Dir FS::openDir(const char *prefix) {
+  HostQuiet quiet;
+  std::shared_ptr<std::vector<std::string>> names = std::make_shared<std::vector<std::string>>();
+  size_t n = strlen(prefix);
+  for(HostFlash::iterator it=flash.begin();it!=flash.end();it++) {
+    if(!it->first.compare(0, n, prefix)) names->push_back(it->first);
+  }
+  return Dir(names);
+}
+
+bool host_flash_load(const char *name, const char *path) {
+  HostQuiet quiet;
+  FILE *fp = fopen(path, "rb");
+  if(!fp) return false;
+  std::shared_ptr<std::string> data = std::make_shared<std::string>();
+  char buf[4096];
+  size_t n;
+  while((n=fread(buf, 1, sizeof(buf), fp))>0) data->append(buf, n);
+  fclose(fp);
+  flash[name] = data;
+  return true;
+}
+
+bool host_flash_save(const char *name, const char *path) {
+  HostQuiet quiet;
+  HostFlash::iterator it = flash.find(name);
+  if(it==flash.end()) return false;
+  FILE *fp = fopen(path, "wb");
+  if(!fp) return false;
+  bool ok = fwrite(it->second->data(), 1, it->second->size(), fp)==it->second->size();
+  return fclose(fp)==0 && ok;
+}
+
+// ======================
+// Web server
+// ======================
+
+/** Handler registered with on(), matched on the exact uri */
+class HostFunctionHandler : public RequestHandler {
+  std::string _uri;
+  HTTPMethod _method;
+  ESP8266WebServer::THandlerFunction _fn, _ufn;
+public:
+  HostFunctionHandler(const char *uri, HTTPMethod method, ESP8266WebServer::THandlerFunction fn,
+                      ESP8266WebServer::THandlerFunction ufn) : _uri(uri), _method(method), _fn(fn), _ufn(ufn) {}
+  bool canHandle(HTTPMethod method, String uri) override {
+    return (_method==HTTP_ANY || _method==method) && uri.s==_uri;
+  }
+  bool handle(ESP8266WebServer&, HTTPMethod method, String uri) override {
+    if(!canHandle(method, uri)) return false;
+    _fn();
+    return true;
+  }
+};
+
+static const char* host_status_text(int code) {
+  switch(code) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+  }
+  return "";
+}
+
+static void host_url_decode(std::string &s) {
+  size_t j = 0;
+  for(size_t i=0;i<s.size();i++) {
+    char c = s[i];
+    if(c=='+') c = ' ';
+    else if(c=='%' && i+2<s.size()) {
+      c = (char)strtol(s.substr(i+1, 2).c_str(), NULL, 16);
+      i += 2;
+    }
+    s[j++] = c;
+  }
+  s.resize(j);
+}
+
+ESP8266WebServer::~ESP8266WebServer() {
+  for(size_t i=0;i<_handlers.size();i++) delete _handlers[i];
+}
+
+void ESP8266WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+  HostQuiet quiet;
+  _handlers.push_back(new HostFunctionHandler(uri.c_str(), method, fn, ufn));
+}
+
+String ESP8266WebServer::arg(String name) {
+  for(size_t i=0;i<_args.size();i++) {
+    if(_args[i].first==name.s) return String(_args[i].second.c_str());
+  }
+  return String("");
+}
+
+String ESP8266WebServer::arg(int i) {
+  return (i>=0 && i<(int)_args.size()) ? String(_args[i].second.c_str()) : String("");
+}
+
+String ESP8266WebServer::argName(int i) {
+  return (i>=0 && i<(int)_args.size()) ? String(_args[i].first.c_str()) : String("");
+}
+
+bool ESP8266WebServer::hasArg(String name) {
+  for(size_t i=0;i<_args.size();i++) {
+    if(_args[i].first==name.s) return true;
+  }
+  return false;
+}
+
+void ESP8266WebServer::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+  HostQuiet quiet;
+  _headers.clear();
+  for(size_t i=0;i<headerKeysCount;i++) _headers.push_back(KeyValue(headerKeys[i], ""));
+}
+
+String ESP8266WebServer::header(String name) {
+  for(size_t i=0;i<_headers.size();i++) {
+    if(!strcasecmp(_headers[i].first.c_str(), name.c_str())) return String(_headers[i].second.c_str());
+  }
+  return String("");
+}
+
+bool ESP8266WebServer::hasHeader(String name) {
+  for(size_t i=0;i<_headers.size();i++) {
+    if(!strcasecmp(_headers[i].first.c_str(), name.c_str())) return !_headers[i].second.empty();
+  }
+  return false;
+}
+
+void ESP8266WebServer::sendHeader(const String& name, const String& value, bool first) {
+  HostQuiet quiet;
+  std::string line = name.s + ": " + value.s + "\r\n";
+  if(first) _responseHeaders.insert(0, line);
+  else _responseHeaders += line;
+}
+
+void ESP8266WebServer::prepareHeader(std::string &out, int code, const char *content_type, size_t length) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s\r\n", code, host_status_text(code));
+  out = buf;
+  out += "Content-Type: ";
+  out += content_type ? content_type : "text/html";
+  out += "\r\n";
+  if(_contentLength==CONTENT_LENGTH_NOT_SET) {
+    snprintf(buf, sizeof(buf), "Content-Length: %u\r\n", (unsigned)length);
+    out += buf;
+  } else if(_contentLength!=CONTENT_LENGTH_UNKNOWN) {
+    snprintf(buf, sizeof(buf), "Content-Length: %u\r\n", (unsigned)_contentLength);
+    out += buf;
+  } else {
+    out += "Transfer-Encoding: chunked\r\n";
+    _chunked = true;
+  }
+  out += _responseHeaders;
+  out += "Connection: close\r\n\r\n";
+  _responseHeaders.clear();
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+}
+
+void ESP8266WebServer::send(int code, const char* content_type, const String& content) {
+  {
+    HostQuiet quiet;
+    std::string head;
+    prepareHeader(head, code, content_type, content.length());
+    client().write((const uint8_t*)head.data(), head.size());
+  }
+  if(content.length()) sendContent(content);
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength) {
+  {
+    HostQuiet quiet;
+    std::string head;
+    prepareHeader(head, code, content_type, contentLength);
+    client().write((const uint8_t*)head.data(), head.size());
+  }
+  sendContent_P(content, contentLength);
+}
+
+bool ESP8266WebServer::chunkedResponseModeStart(int code, const char* content_type) {
+  setContentLength(CONTENT_LENGTH_UNKNOWN);
+  send(code, content_type, String(""));
+  return true;
+}
+
+void ESP8266WebServer::sendContent_P(PGM_P content, size_t size) {
+  WiFiClient c = client();
+  if(_chunked) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%x\r\n", (unsigned)size);
+    c.write(buf);
+  }
+  c.write((const uint8_t*)content, size);
+  if(_chunked) {
+    c.write("\r\n");
+    if(!size) _chunked = false;  // last chunk
+  }
+}
+
+void ESP8266WebServer::hostHeader(const char *name, const char *value) {
+  HostQuiet quiet;
+  _requestHeaders.push_back(KeyValue(name, value));
+}
+
+void ESP8266WebServer::hostRequest(HostConn *conn, HTTPMethod method, const char *uri, const char *query, const char *body) {
+  {
+    HostQuiet quiet;
+    _conn = conn;
+    _conn->open = true;
+    _method = method;
+    _uri = uri;
+    _args.clear();
+    for(const char *p=query;p && *p;) {
+      const char *e = strchr(p, '&');
+      if(!e) e = p+strlen(p);
+      const char *eq = (const char*)memchr(p, '=', e-p);
+      KeyValue kv(std::string(p, eq?eq:e), eq ? std::string(eq+1, e) : std::string());
+      host_url_decode(kv.first);
+      host_url_decode(kv.second);
+      if(!kv.first.empty()) _args.push_back(kv);
+      p = *e ? e+1 : e;
+    }
+    if(body) _args.push_back(KeyValue("plain", body));
+    for(size_t i=0;i<_headers.size();i++) {
+      _headers[i].second.clear();
+      for(size_t k=0;k<_requestHeaders.size();k++) {
+        if(!strcasecmp(_headers[i].first.c_str(), _requestHeaders[k].first.c_str()))
+          _headers[i].second = _requestHeaders[k].second;
+      }
+    }
+    _requestHeaders.clear();
+    // like the core, response headers set but never sent stay for the next response
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _chunked = false;
+  }
+
+  bool handled = false;
+  for(size_t i=0;i<_handlers.size() && !handled;i++) {
+    if(_handlers[i]->canHandle(_method, _uri)) handled = _handlers[i]->handle(*this, _method, _uri);
+  }
+  if(!handled) {
+    if(_notFound) _notFound();
+    else send(404, "text/plain", String("Not found: ")+_uri);
+  }
+
+  // unless a handler kept the client to respond later, the request is over
+  if(!_conn->refs) _conn->open = false;
+  _conn = NULL;
+}
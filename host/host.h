@@ -0,0 +1,51 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: controls of the stand-in core used by the benchmark
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_H
+#define _HOST_H
+
+#include "Arduino.h"
+
+/** Skip the clock ahead
+ * millis() and micros() follow the host's monotonic clock plus the
+ * skipped time, so delay() returns at once and rate limits can be
+ * refilled without waiting.
+ */
+void host_advance(unsigned long ms);
+
+/** Allocations made while host_quiet>0 are not counted
+ * The stand-ins raise it around their own bookkeeping so that only
+ * allocations made by the firmware (and the Strings it gets from the
+ * core) show up in the counts.
+ */
+extern int host_quiet;
+extern unsigned long host_allocs;       // number of counted allocations
+extern unsigned long host_alloc_bytes;  // bytes of counted allocations
+
+struct HostQuiet {
+  HostQuiet() { host_quiet++; }
+  ~HostQuiet() { host_quiet--; }
+};
+
+bool host_flash_load(const char *name, const char *path);  // copy a host file into flash
+bool host_flash_save(const char *name, const char *path);  // copy a flash file to the host
+
+#endif  // _HOST_H
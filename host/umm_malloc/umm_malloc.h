@@ -0,0 +1,41 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Host build: stand-in for the 2.4 core's allocator statistics
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_UMM_MALLOC_H
+#define _HOST_UMM_MALLOC_H
+
+typedef struct UMM_HEAP_INFO_t {
+  unsigned short int totalEntries;
+  unsigned short int usedEntries;
+  unsigned short int freeEntries;
+
+  unsigned short int totalBlocks;
+  unsigned short int usedBlocks;
+  unsigned short int freeBlocks;
+
+  unsigned short int maxFreeContiguousBlocks;
+} UMM_HEAP_INFO;
+
+extern UMM_HEAP_INFO ummHeapInfo;
+
+void *umm_info(void *ptr, int force);
+
+#endif  // _HOST_UMM_MALLOC_H
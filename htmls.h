@@ -119,11 +119,15 @@ id('pw').value='';
 } else if (jd.result==2) {
 show_msg('Check device key and try again.', 10000, 'red');
 } else {
-show_msg('Update failed.',0,'red');
+show_msg('Update failed'+(jd.item?' ('+jd.item+').':'.'),0,'red');
 }
 }
 };
-xhr.open('POST', 'update', true);
+xhr.upload.onprogress = function(e) {
+if(e.lengthComputable) show_msg('Uploading '+Math.floor(e.loaded*100/e.total)+'%...',0,'green');
+};
+xhr.onerror = function() {show_msg('Update failed.',0,'red');};
+xhr.open('POST', 'update?size='+file.size, true);
 xhr.send(fd);
 });
 </script>
@@ -181,11 +185,15 @@ id('pw').value='';
 } else if (jd.result==2) {
 show_msg('Check device password and try again.', 10000, 'red');
 } else {
-show_msg('Update failed.',0,'red');
+show_msg('Update failed'+(jd.item?' ('+jd.item+').':'.'),0,'red');
 }
 }
 };
-xhr.open('POST', 'update', true);
+xhr.upload.onprogress = function(e) {
+if(e.lengthComputable) show_msg('Uploading '+Math.floor(e.loaded*100/e.total)+'%...',0,'green');
+};
+xhr.onerror = function() {show_msg('Update failed.',0,'red');};
+xhr.open('POST', 'update?size='+file.size, true);
 xhr.send(fd);
 });
 </script>
@@ -0,0 +1,251 @@
+/* Generated by make_htmls_gz.py from htmls.h, do not edit */
+
+#ifndef _HTMLS_GZ_H
+#define _HTMLS_GZ_H
+
+// ap_home_html: 3528 bytes, 1398 compressed
+const uint8_t ap_home_html_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xcd,0x57,0x6d,0x6f,0xdb,0x36,
+  0x10,0xfe,0x3c,0xff,0x0a,0xce,0xc3,0x4a,0x19,0x72,0xe4,0x38,0xeb,0xba,0xc2,0x32,
+  0x35,0xa0,0x2f,0x6b,0x33,0xb4,0x4b,0x50,0x67,0xe8,0x86,0x61,0x18,0x68,0x91,0xb6,
+  0x19,0xd3,0xa4,0x46,0x52,0x71,0xbc,0x20,0xff,0x7d,0x47,0x4a,0xb2,0x65,0xc7,0x7d,
+  0xd9,0x3e,0x0c,0x2b,0x10,0x98,0xba,0xf7,0x3b,0x3e,0x77,0xbc,0x8e,0x17,0x9c,0xb2,
+  0xac,0x33,0x76,0xc2,0x49,0x9e,0x5d,0x14,0x5c,0x4d,0x0a,0x23,0xd4,0x52,0x72,0x83,
+  0xde,0x8b,0x1f,0x04,0x7a,0xae,0xd5,0x4c,0xcc,0xc7,0x83,0x4a,0xa0,0x33,0x5e,0x71,
+  0x47,0x91,0xa2,0x2b,0x4e,0xf0,0x8d,0xe0,0xeb,0x42,0x1b,0x87,0x51,0xae,0x95,0xe3,
+  0xca,0x11,0xbc,0x16,0xcc,0x2d,0x08,0xe3,0x37,0x22,0xe7,0x27,0xe1,0xa3,0x8f,0x84,
+  0x12,0x4e,0x50,0x79,0x62,0x73,0x2a,0x39,0x19,0x62,0x30,0x32,0xa8,0xbd,0x4e,0x35,
+  0xdb,0xc0,0x8f,0x75,0x1b,0xb0,0x8d,0x1c,0x9d,0x4a,0xde,0x47,0x5e,0xc7,0x31,0x74,
+  0xf7,0xc5,0x54,0x1b,0xc6,0xcd,0x08,0x9d,0x16,0xb7,0xc8,0x6a,0x29,0x18,0x9a,0x4a,
+  0x9a,0x2f,0x53,0x84,0x2a,0xce,0x49,0xae,0xa5,0xa4,0x85,0xe5,0x23,0xd4,0x9c,0xd2,
+  0xfb,0x4e,0xb0,0xf2,0x95,0x61,0x60,0x07,0xdd,0xa1,0xc6,0xc6,0xf0,0xc0,0x46,0x5b,
+  0xae,0xed,0xeb,0x50,0xee,0x63,0xae,0xc6,0x83,0x2a,0xf0,0xce,0x38,0xa7,0x85,0x13,
+  0x5a,0x65,0xe3,0xe9,0xc7,0x4a,0xb8,0x93,0x32,0xe1,0x0f,0xaa,0xee,0x63,0x40,0x39,
+  0x97,0xd2,0x16,0x34,0x17,0x6a,0x4e,0x1e,0x23,0xc1,0x08,0x36,0xcc,0x57,0xc9,0x81,
+  0x98,0x63,0xd9,0x0b,0xee,0x78,0xee,0x38,0x43,0x93,0xc9,0xf9,0x0b,0x0b,0x37,0xc1,
+  0x02,0x79,0xe2,0x0c,0x57,0x73,0xb7,0xd8,0x12,0x2e,0xf5,0x1a,0x3c,0xbe,0xe1,0x37,
+  0x5c,0x56,0xb4,0x81,0x33,0x3b,0x2b,0xd1,0x24,0xa7,0x4a,0x81,0x8b,0x24,0x49,0x7a,
+  0x6d,0xfe,0x20,0x04,0xe1,0x2f,0xe3,0xc3,0x51,0x0d,0x9f,0xec,0x0c,0x8d,0x85,0x2a,
+  0x4a,0x87,0xdc,0xa6,0x00,0x08,0x38,0x7e,0x0b,0xd7,0x5f,0xc1,0xc1,0x5a,0xc1,0x70,
+  0x08,0xbf,0x3a,0x85,0xe2,0x10,0x3c,0x03,0x6c,0x9c,0x58,0xf1,0x17,0x1f,0x0d,0x1f,
+  0x17,0x2e,0x5d,0x70,0x31,0x5f,0xb8,0xd1,0xd9,0xd3,0xe2,0x36,0xc5,0xd9,0x36,0xf8,
+  0xe8,0x57,0x5d,0xd6,0xe5,0xf2,0x69,0xf6,0x8e,0x64,0xb0,0xe7,0xb8,0xa0,0xd6,0xae,
+  0xe1,0x6a,0x1a,0xe7,0xfe,0xbb,0x72,0x5e,0x9d,0xfe,0xad,0xf3,0xcb,0xda,0xee,0x27,
+  0x03,0x68,0x67,0x4e,0x4b,0xb7,0xa8,0x9c,0x57,0xa7,0x7f,0xe4,0x7c,0x2c,0xe9,0x94,
+  0xcb,0xa0,0x2d,0xa7,0xf2,0x8f,0x60,0x21,0x8b,0x9e,0xc9,0x8d,0x5a,0xa2,0x2b,0xbd,
+  0xe4,0xaa,0x8f,0x2e,0x02,0x6e,0xa8,0x84,0xa0,0x82,0x70,0xf6,0x30,0x38,0x0f,0x4b,
+  0xb8,0x2d,0x45,0xce,0xb2,0x71,0x11,0x8c,0xad,0xec,0xdc,0x7b,0x29,0xb2,0x63,0x99,
+  0x4c,0x4b,0xe7,0xb4,0xaa,0x53,0xa9,0x3e,0xaa,0x04,0xfc,0x19,0x23,0xad,0x72,0x29,
+  0xf2,0x25,0xdc,0xe4,0x2c,0xea,0xa5,0xdb,0x84,0xea,0x0c,0xbe,0x79,0x02,0x19,0x84,
+  0xe6,0x1e,0x0d,0x9f,0x42,0x73,0xe2,0x6c,0x52,0x4e,0x57,0xc2,0x8d,0x07,0x95,0xa5,
+  0x56,0x6e,0xc7,0x70,0x66,0x73,0x23,0x0a,0x97,0x75,0x66,0xa5,0xca,0x7d,0x5e,0xe0,
+  0x37,0xb2,0x3d,0x74,0x67,0xb8,0x2b,0x8d,0x42,0x4c,0xe7,0xe5,0x0a,0x86,0x49,0x32,
+  0xe7,0xee,0xa5,0xe4,0xfe,0xf8,0x6c,0x73,0xee,0x45,0xa0,0x69,0xb7,0x3a,0x96,0xcb,
+  0x48,0x80,0x12,0xe8,0x56,0x70,0xeb,0x25,0x37,0x54,0x96,0x9c,0x78,0x02,0xc0,0x22,
+  0x16,0x35,0x01,0x94,0x6e,0xa8,0x41,0x2e,0x17,0xe9,0x4e,0xdb,0x99,0x0d,0x34,0xa5,
+  0x82,0xb6,0x8a,0xc0,0x46,0x10,0xb8,0x5d,0x18,0xa2,0xf8,0x1a,0xfd,0xf2,0xf6,0xcd,
+  0x6b,0xe7,0x8a,0x77,0xfc,0xcf,0x92,0x5b,0x60,0xa7,0x1d,0xe0,0x24,0x5a,0x19,0x98,
+  0x58,0x1b,0xeb,0x28,0xf4,0xe2,0x82,0xaa,0x39,0x27,0x8d,0xb1,0x60,0x41,0xcc,0x22,
+  0x2f,0x16,0x84,0x26,0x5e,0x88,0x40,0x27,0x3f,0x7a,0xe4,0xad,0x26,0x5e,0xa9,0xb4,
+  0x84,0x9c,0x9d,0x9e,0x36,0xce,0xae,0x19,0xf9,0x71,0x72,0xf1,0x53,0x52,0x50,0x63,
+  0x79,0xad,0x69,0x0b,0xad,0x2c,0xbf,0x02,0x58,0x81,0x4f,0xb0,0x77,0xcd,0x12,0x51,
+  0x10,0x02,0x3a,0x55,0x61,0xd2,0xa0,0x09,0x24,0x8c,0xe3,0x8a,0xf9,0xf5,0xd9,0xb7,
+  0x4f,0x7a,0x31,0x4e,0xe0,0xbb,0x22,0x0c,0x80,0x90,0x65,0xa7,0xbd,0x36,0x63,0x9f,
+  0xf3,0xf9,0x12,0xcd,0x2f,0xc4,0x02,0x15,0xf5,0x60,0xea,0x25,0x02,0x4a,0x66,0x5e,
+  0x5f,0xbd,0x7d,0x43,0x30,0x4c,0xba,0xb1,0xc7,0xb7,0xc7,0x9d,0x36,0x64,0x6e,0x38,
+  0x57,0x59,0x5d,0x53,0xce,0xbe,0x44,0x2f,0xc2,0x13,0x80,0xce,0x2f,0x47,0x08,0xee,
+  0xa2,0x88,0xf1,0x78,0xe0,0xc5,0x01,0x0c,0xd3,0x30,0x65,0x6a,0xbe,0xb0,0x90,0xdd,
+  0x54,0x6b,0xe7,0x07,0x13,0x9a,0xac,0x85,0xcb,0x17,0x68,0x0a,0x83,0x17,0x39,0xed,
+  0xc5,0xdc,0x82,0x23,0x3a,0xd5,0x37,0xbc,0xea,0x4e,0xc5,0x1d,0x34,0xe7,0xb2,0x8f,
+  0xa8,0xf2,0xf3,0x9d,0x2b,0x2f,0x13,0xa0,0xea,0xbf,0x50,0x8d,0x6a,0xe8,0x10,0xbd,
+  0x06,0x03,0x60,0x9a,0x09,0x03,0x01,0x25,0x38,0x24,0x11,0xb0,0xbd,0x97,0xc5,0x2b,
+  0xed,0xc5,0x7c,0x80,0x69,0x4b,0x80,0x09,0xeb,0xa1,0xca,0xc8,0x8c,0x4a,0x98,0xf3,
+  0x6d,0xdd,0xa6,0x31,0xb6,0x48,0x32,0x2c,0xea,0xdd,0xad,0x85,0x62,0x7a,0x9d,0x68,
+  0x18,0xfd,0x11,0x5e,0x00,0x7a,0x46,0x83,0x81,0x37,0xea,0x11,0x9b,0x4b,0x4e,0xcd,
+  0x39,0x3c,0x8f,0x06,0xe0,0x18,0x01,0x0c,0xa1,0xa2,0xf7,0x9d,0x7b,0x04,0xff,0x2a,
+  0x64,0x05,0xa5,0x57,0x2f,0xaf,0x70,0x1f,0xe1,0x6b,0x47,0x0b,0xf8,0x75,0xa6,0xe4,
+  0xbd,0xb4,0x02,0x0f,0x57,0xcc,0x83,0x10,0x14,0x5a,0xe0,0x9f,0x55,0xa0,0x3b,0x76,
+  0x31,0x38,0xfd,0xdf,0xc2,0x19,0x88,0xa5,0x74,0x84,0x0c,0x41,0x0f,0x1d,0xbf,0x90,
+  0x1a,0x41,0xd5,0x33,0x85,0x53,0x74,0x1c,0x7b,0x7b,0xc0,0xa3,0x9b,0x6c,0xa7,0xd5,
+  0x47,0x05,0xd4,0xdb,0x72,0xb4,0xa6,0xc2,0x81,0x89,0x1a,0x75,0x60,0x09,0x2a,0x4f,
+  0x2c,0x77,0xbb,0x9b,0xd8,0x8e,0x80,0x3e,0x1a,0x9e,0x42,0x2e,0x69,0xd3,0x67,0xe8,
+  0xfe,0xb3,0x20,0x0f,0xe0,0xca,0x5e,0x1a,0xa3,0x0d,0x7c,0x33,0xee,0x61,0xbe,0x4d,
+  0x31,0x86,0x3b,0x14,0x8e,0xaf,0x6a,0xa2,0x3f,0xee,0x35,0x40,0x9d,0xd8,0xc3,0xf4,
+  0xab,0x39,0xba,0xcf,0x3e,0x40,0x63,0x6b,0xe0,0x1d,0xe1,0x84,0xc7,0xef,0x28,0x27,
+  0xbc,0x2b,0x0f,0xb1,0x0d,0x50,0xac,0x00,0x93,0xeb,0xd5,0x8a,0xe0,0x1c,0x76,0x94,
+  0xef,0xbd,0x79,0x82,0x63,0xae,0x7c,0x62,0x3f,0xbf,0x3b,0x7f,0xae,0x57,0x70,0x99,
+  0x30,0x87,0xa3,0xc3,0x69,0x0b,0x23,0xe4,0x91,0x77,0xf9,0x61,0xe9,0x3a,0xa0,0xad,
+  0xb4,0x0f,0x03,0xa4,0x5b,0x11,0x55,0x53,0xfa,0x41,0x2f,0xf8,0x78,0x8e,0x76,0xc2,
+  0xb1,0xd2,0x78,0xb1,0xa3,0x95,0xd9,0x32,0x0e,0x0b,0xb3,0x65,0x1c,0xd6,0x25,0x30,
+  0xa0,0x2c,0xbb,0x6e,0x93,0x9a,0xb2,0xb0,0x7a,0xfd,0xf7,0x6f,0x45,0xfd,0x98,0x41,
+  0x78,0x5c,0xc2,0x16,0xf8,0x4e,0xaf,0xa3,0x61,0xaf,0x7e,0x08,0xfa,0x9f,0x6e,0xbb,
+  0x99,0x36,0x91,0x20,0xa7,0xa9,0x18,0x03,0x0a,0x7d,0x69,0x6c,0x22,0xc3,0xce,0x98,
+  0x8a,0x38,0x6e,0x92,0xb1,0x62,0x0e,0xab,0x85,0xad,0xb7,0x49,0x82,0x3c,0x8a,0x41,
+  0xd6,0xfe,0x26,0x7e,0xcf,0x4e,0xbe,0x1b,0x7e,0x8f,0x2f,0x96,0x78,0x14,0xed,0x51,
+  0x9f,0x02,0xf5,0x3d,0xa7,0x40,0xc7,0x97,0x5a,0x1b,0x5c,0x87,0x64,0xf4,0x9a,0x6c,
+  0x23,0x16,0x10,0x86,0x71,0x3e,0xe2,0x13,0x1f,0x32,0xf0,0x76,0x40,0x47,0xa4,0x7b,
+  0xb0,0x53,0xed,0x36,0xc8,0x7a,0x8b,0x33,0xac,0x1b,0x8b,0xb8,0xdb,0x5e,0x45,0xe0,
+  0xc5,0xef,0xa2,0x18,0x09,0xf8,0xeb,0xf6,0x70,0xbd,0xbb,0x18,0xca,0x84,0xc6,0xa8,
+  0x7a,0xfb,0x71,0x37,0x6e,0x12,0x85,0x38,0x41,0x3b,0xf3,0x0a,0x2d,0x92,0x57,0x0d,
+  0x3b,0x49,0x17,0x85,0x23,0xec,0x4d,0x54,0x42,0xfe,0x00,0x7c,0xee,0x07,0x03,0x28,
+  0xc4,0xfb,0xf5,0x88,0x1b,0xf9,0xe3,0xe2,0x51,0xf0,0xd8,0x54,0x06,0xc5,0x5d,0xc4,
+  0xa6,0xab,0x5e,0x4b,0xc5,0xef,0x3e,0xdd,0xba,0xcd,0xee,0x0f,0x41,0x8e,0xaf,0xad,
+  0x9f,0xf7,0xc7,0xc6,0x7d,0x07,0x66,0xd5,0x95,0x58,0x71,0x5d,0xba,0x68,0x0b,0xc0,
+  0x66,0x52,0xc1,0x32,0xd5,0x2c,0x51,0x30,0x4e,0xc2,0xff,0xa1,0xfe,0x06,0x46,0x7d,
+  0x81,0xa9,0xc8,0x0d,0x00,0x00,
+};
+
+// ap_update_html: 1984 bytes, 1043 compressed
+const uint8_t ap_update_html_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x75,0x55,0x6d,0x4f,0xe4,0x36,
+  0x10,0xfe,0xbe,0xbf,0x62,0xfa,0xa1,0xe7,0xa4,0xbb,0x78,0xe1,0x0e,0x55,0x15,0x24,
+  0x8b,0xae,0xc7,0x9d,0xae,0x15,0x14,0x74,0x70,0x52,0xab,0xaa,0x42,0xde,0x78,0xb2,
+  0xeb,0xc3,0xb1,0x53,0xdb,0xd9,0x65,0x8b,0xf8,0xef,0x1d,0x3b,0x59,0x58,0x28,0x15,
+  0x5a,0x92,0x38,0xf3,0xf2,0xcc,0x33,0xcf,0x4c,0x8a,0x25,0x0a,0x39,0x1b,0x15,0x41,
+  0x05,0x8d,0xb3,0x8b,0x16,0xcd,0x55,0xeb,0x94,0xb9,0xd5,0xe8,0xe0,0x93,0x72,0xcd,
+  0x5a,0x38,0x84,0xaf,0xad,0x14,0x01,0x8b,0x69,0x6f,0x34,0x2a,0x1a,0x0c,0x02,0x8c,
+  0x68,0xb0,0x64,0x2b,0x85,0xeb,0xd6,0xba,0xc0,0xa0,0xb2,0x26,0xa0,0x09,0x25,0x5b,
+  0x2b,0x19,0x96,0xa5,0xc4,0x95,0xaa,0x70,0x2f,0x3d,0x4c,0x40,0x19,0x15,0x94,0xd0,
+  0x7b,0xbe,0x12,0x1a,0xcb,0x03,0x46,0x41,0xa6,0x43,0xe6,0xb9,0x95,0x1b,0xba,0x48,
+  0xb5,0x02,0x25,0x4b,0xd6,0x8a,0x05,0xde,0x74,0x29,0x21,0xeb,0x8f,0x67,0xc5,0xf2,
+  0xdd,0x0b,0x64,0xef,0x2f,0xf7,0x1a,0x2b,0xf1,0xbf,0x08,0xc9,0xb2,0x98,0x46,0x9f,
+  0xde,0x73,0x54,0xd4,0xd6,0x35,0x40,0x78,0x97,0x96,0x62,0x5f,0x5e,0x5c,0x5d,0x33,
+  0x10,0x55,0x50,0xd6,0x94,0x6c,0x3a,0x64,0x49,0x69,0xeb,0x86,0x01,0x9a,0x2a,0x6c,
+  0x5a,0x2a,0xaa,0xe9,0x74,0x50,0xad,0x70,0x61,0x1a,0xdd,0xf7,0xc8,0x4a,0x44,0x2c,
+  0x41,0xcc,0x35,0x42,0x85,0x5a,0xfb,0x56,0x54,0xca,0x2c,0xca,0xc3,0x78,0xea,0x66,
+  0x45,0x90,0xb3,0x42,0x99,0xb6,0x0b,0xd0,0x07,0xa8,0x95,0xa6,0xb8,0x3d,0x43,0xfd,
+  0xbd,0xa8,0x2a,0x6c,0x89,0x1c,0x3e,0x57,0x66,0xc8,0x18,0xcf,0x09,0x6d,0xf4,0x9d,
+  0x52,0x90,0xa7,0x48,0xf3,0xd9,0x69,0x22,0x0f,0x5a,0xe1,0xfd,0xda,0x3a,0x79,0x04,
+  0xc5,0x74,0xfe,0x3c,0xc3,0xf6,0xd5,0x36,0x4b,0xbb,0x66,0xe0,0xd5,0x3f,0x58,0xbe,
+  0xfb,0x11,0x1a,0x71,0xa7,0xd1,0x2c,0xa8,0x09,0xf4,0x90,0x38,0x5d,0xbf,0x9e,0x48,
+  0x8b,0x39,0xea,0x64,0xd1,0xf8,0x45,0x34,0x49,0x07,0xcf,0x4c,0xa7,0xa9,0xe8,0xd8,
+  0xa6,0x2e,0x04,0x6b,0x92,0xf1,0x3c,0x98,0x1b,0xdf,0xcd,0x1b,0x45,0x5d,0xf7,0x61,
+  0x43,0x0d,0x65,0x4b,0x54,0x8b,0x65,0x38,0x3a,0xfc,0xa9,0xbd,0x3b,0x66,0xb3,0xab,
+  0xf4,0xb2,0x98,0x8a,0x18,0x20,0x52,0x18,0xaf,0x7d,0x3f,0x86,0x8b,0xaf,0x9c,0x6a,
+  0xc3,0x6c,0x54,0x77,0x26,0x75,0x83,0xe2,0x66,0x3e,0x87,0x7b,0x87,0xa1,0x73,0x06,
+  0xa4,0xad,0xba,0x86,0xc4,0xc4,0x17,0x18,0x3e,0x6a,0x8c,0xb7,0x3f,0x6f,0x7e,0x89,
+  0x26,0xc7,0x0f,0x4f,0x3e,0x95,0x46,0xe1,0x6e,0x08,0x7a,0x46,0x9e,0x14,0x20,0x55,
+  0x91,0x73,0x65,0x0c,0xba,0xcf,0xd7,0xe7,0x67,0x25,0x63,0xbb,0xe6,0x7e,0x69,0xd7,
+  0xc9,0xda,0x4f,0xc2,0xa4,0x22,0x97,0xd1,0x6b,0x3e,0x9e,0xd7,0x24,0xe4,0xca,0x6a,
+  0xeb,0xb2,0x2a,0x3f,0x1e,0xa9,0x3a,0x0b,0xb3,0xfd,0x1c,0x3c,0x86,0x6b,0xd5,0xa0,
+  0xed,0x42,0xf6,0x98,0x77,0x02,0x81,0x2c,0x1e,0x52,0x9c,0x1d,0x52,0x72,0x2e,0xa4,
+  0xfc,0xb8,0x22,0xd0,0x67,0xca,0xd3,0x4c,0xa0,0xcb,0x58,0xa5,0x55,0x75,0xcb,0x26,
+  0xb0,0x45,0x93,0x61,0x7e,0x3f,0x42,0xde,0x3a,0x8c,0x76,0xa7,0x58,0x0b,0xd2,0x5c,
+  0x46,0xd1,0x56,0xc2,0x41,0x94,0x86,0x2f,0x23,0x27,0xbd,0x4a,0x72,0x9e,0x4e,0x12,
+  0x98,0x74,0xc7,0x87,0xfe,0x96,0x04,0xec,0xfe,0xb1,0x2e,0x76,0x49,0xc0,0x3c,0x12,
+  0x54,0x8d,0x55,0x00,0x91,0xe2,0x70,0x36,0x79,0xbb,0xbf,0xbf,0x3f,0x61,0x0e,0x25,
+  0xcb,0x8f,0xa1,0x67,0x98,0x78,0xa1,0x58,0x31,0x01,0x69,0x23,0xe7,0x2b,0xa1,0x3b,
+  0x2c,0x89,0xaf,0xc4,0x4a,0x9d,0x7d,0x47,0xc3,0x5c,0xd3,0x6c,0x65,0xec,0x0f,0xdb,
+  0x81,0x54,0x12,0x8c,0x0d,0xd0,0xeb,0x4f,0x40,0x3f,0xda,0x70,0x8b,0x1b,0x0e,0xef,
+  0x69,0xf8,0x36,0x64,0xe3,0x3b,0x87,0x27,0x2c,0xcf,0xb7,0xf1,0x89,0x95,0x27,0x5c,
+  0x5f,0x5b,0x6d,0x85,0xa4,0x81,0xe1,0x30,0x40,0x5c,0x0b,0x15,0x38,0x27,0x6c,0x07,
+  0xfb,0x09,0xdc,0xc2,0x21,0x1a,0xb6,0x2d,0x5f,0x42,0x09,0x06,0xd7,0xf0,0x89,0xa4,
+  0x73,0x4a,0xc3,0xb7,0xcb,0x0b,0xbd,0x4a,0x14,0xfc,0xb9,0xff,0xd7,0xf1,0xa8,0x96,
+  0x5c,0xb4,0xb4,0x19,0xb6,0x44,0x4d,0xd2,0xbb,0xfe,0x3f,0x8f,0x83,0x91,0x3f,0xb3,
+  0xa1,0x5a,0x27,0xf0,0xbc,0xe8,0x21,0xf2,0xdd,0xd2,0x0d,0x39,0x7f,0x3f,0x3f,0xfb,
+  0x1c,0x42,0xfb,0x05,0xff,0xee,0xd0,0xa7,0x8e,0xd0,0x3b,0x6e,0x8d,0xa3,0x6d,0xb5,
+  0xf1,0x81,0x16,0x46,0xb5,0x14,0x66,0x91,0x70,0x6c,0x7b,0x39,0xb0,0x16,0x0d,0x93,
+  0xd9,0x55,0x34,0x2b,0xcb,0x43,0x78,0xf3,0x26,0x46,0xe6,0xd1,0xad,0xf3,0x65,0x49,
+  0x8d,0x88,0xa6,0x31,0xe1,0x37,0x59,0xfe,0x7a,0x75,0xf1,0x1b,0xa7,0x2d,0xe3,0x71,
+  0xf0,0xf4,0xad,0x35,0x1e,0xaf,0xf1,0x2e,0xf4,0xba,0xfb,0x26,0xe3,0x21,0xe9,0xa2,
+  0x2c,0x0f,0xa2,0xdf,0x2e,0xa1,0x71,0x73,0x81,0xf2,0xc4,0x3b,0x2d,0x16,0xef,0xeb,
+  0x4e,0x73,0xf8,0x82,0x73,0x6b,0x43,0xa4,0x99,0x4d,0x76,0x39,0x7d,0xd1,0x66,0x9a,
+  0x8a,0xd1,0x03,0xa0,0xa6,0x36,0xa8,0x1a,0x76,0xb3,0xbc,0x7d,0x9e,0xe5,0xc3,0x12,
+  0xab,0xdb,0x9d,0x6e,0x83,0x30,0x12,0x82,0xa3,0xeb,0x42,0x28,0x43,0x49,0xa0,0xef,
+  0x1e,0x0c,0xda,0xda,0x46,0x7d,0x05,0x69,0x2d,0xa8,0x23,0x92,0x8d,0x63,0x36,0x15,
+  0xb0,0x39,0x61,0x90,0xb1,0xf1,0xf0,0x30,0x26,0x68,0xec,0x88,0x71,0x96,0x4f,0x1e,
+  0x75,0x4a,0xfa,0xa1,0xbf,0x9e,0xfc,0x2e,0xc9,0x87,0x7a,0xd0,0x3a,0x4b,0x45,0x79,
+  0xbf,0xcb,0x3d,0x0e,0xe4,0xe3,0x30,0x13,0x1f,0x6c,0x43,0x2a,0x8d,0x4b,0x2b,0x87,
+  0x57,0x14,0x08,0x6c,0x7c,0x2e,0xc2,0x92,0xd7,0xda,0xd2,0x80,0x93,0x13,0x1d,0xa3,
+  0xfc,0x81,0x0a,0x99,0x22,0x0f,0x36,0x08,0x9d,0x8f,0xd9,0xf7,0x49,0x9a,0xbb,0x14,
+  0x3e,0x6c,0x65,0x80,0xce,0x59,0xf7,0xa2,0xf7,0xff,0x53,0x6d,0x1f,0xa2,0x2f,0x67,
+  0xeb,0x4f,0x3a,0xcc,0xfa,0xcf,0x10,0xb1,0xd6,0x7f,0x7f,0x4e,0xd2,0xda,0x66,0xe3,
+  0xa4,0xd9,0x78,0x4f,0x5b,0xc5,0x25,0x61,0x26,0xe9,0x44,0xe1,0xd6,0x32,0x42,0xa0,
+  0x5f,0x31,0xdd,0x2e,0x4e,0xfa,0x20,0xa4,0xef,0xe6,0xbf,0xd3,0x6c,0xaa,0xb9,0xc0,
+  0x07,0x00,0x00,
+};
+
+// sta_update_html: 2651 bytes, 1257 compressed
+const uint8_t sta_update_html_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x8d,0x56,0x7f,0x6f,0xdb,0x36,
+  0x10,0xfd,0xdf,0x9f,0x82,0x43,0xb7,0x50,0x5a,0x6c,0x2a,0x69,0x8a,0x01,0x4b,0x2c,
+  0x17,0x5b,0xbb,0xa2,0x1b,0x9a,0xb5,0x68,0x52,0x60,0xc3,0x30,0x04,0x14,0x75,0xb2,
+  0x98,0x50,0xa4,0x46,0x52,0x51,0xbc,0x20,0xdf,0x7d,0x47,0x4a,0x4a,0xe3,0xc6,0xc5,
+  0x82,0xc0,0x11,0x45,0x1d,0xdf,0xbb,0x1f,0xef,0x4e,0x5a,0xd6,0xc0,0xcb,0xd5,0x6c,
+  0xe9,0xa5,0x57,0xb0,0x7a,0xdf,0x82,0x3e,0x6b,0xad,0xd4,0x57,0x0a,0x2c,0x79,0x23,
+  0x6d,0xd3,0x73,0x0b,0xe4,0x53,0x5b,0x72,0x0f,0xcb,0x6c,0x30,0x9a,0x2d,0x1b,0xf0,
+  0x9c,0x68,0xde,0x40,0x4e,0xaf,0x25,0xf4,0xad,0xb1,0x9e,0x12,0x61,0xb4,0x07,0xed,
+  0x73,0xda,0xcb,0xd2,0xd7,0x79,0x09,0xd7,0x52,0xc0,0x22,0xde,0xcc,0x89,0xd4,0xd2,
+  0x4b,0xae,0x16,0x4e,0x70,0x05,0xf9,0x21,0x45,0x10,0x85,0x2c,0xc4,0x82,0xca,0xa9,
+  0xf3,0x1b,0x05,0xae,0x06,0x40,0x94,0xda,0x42,0x95,0xd3,0xda,0xfb,0xf6,0x38,0xcb,
+  0x84,0x29,0x81,0x5d,0xfe,0xd3,0x81,0xdd,0x30,0x61,0x9a,0xac,0x31,0x85,0x54,0x90,
+  0x1d,0xb2,0x23,0x76,0x98,0x8d,0xfb,0xc3,0xde,0x22,0xee,0xb1,0x46,0x6a,0x26,0x9c,
+  0xa3,0xc4,0x6f,0x5a,0x74,0xce,0xc3,0x8d,0xcf,0xc2,0x3d,0xd2,0x39,0x61,0x65,0xeb,
+  0x89,0xb3,0xe2,0xab,0xf0,0xc3,0x12,0xa1,0x7e,0x1c,0xa1,0x2e,0xb7,0x91,0x2e,0xf9,
+  0x35,0x1f,0x60,0xe8,0x6a,0x99,0x0d,0xab,0xa7,0x21,0x3f,0xc9,0xf1,0xa7,0xb1,0x65,
+  0x63,0xc1,0x0a,0x53,0x6e,0xf0,0x52,0xca,0x6b,0x82,0xc5,0xe1,0x0b,0x6b,0x30,0xb1,
+  0xb4,0xe5,0x6b,0xa0,0x44,0x96,0xc3,0xea,0xa2,0x8b,0x85,0xa3,0x8f,0xed,0x02,0x08,
+  0x58,0x04,0xae,0x8f,0xfe,0xaf,0xe8,0x68,0xb1,0xcc,0xf0,0xf8,0x63,0x90,0xb1,0xe2,
+  0x01,0xbe,0x32,0xb6,0x21,0x28,0x8b,0xda,0x20,0xf5,0x87,0xf7,0x67,0xe7,0x94,0x70,
+  0xe1,0xa5,0xd1,0x39,0xcd,0x46,0x27,0xa2,0x57,0x55,0x43,0x09,0x68,0x31,0x84,0xd9,
+  0x74,0xca,0xcb,0x96,0x5b,0x9f,0x85,0xe3,0x8b,0x80,0x1c,0xb0,0x3c,0x2f,0x14,0x10,
+  0x01,0x4a,0xb9,0x96,0x0b,0xa9,0xd7,0xf9,0x8b,0xb0,0x6b,0x57,0x4b,0x5f,0xae,0x96,
+  0x52,0xb7,0x9d,0x1f,0xf3,0x54,0x61,0x02,0xe9,0x28,0xc4,0x61,0xcd,0x85,0x80,0x16,
+  0x35,0xc8,0x0a,0xa9,0x47,0xc6,0xb0,0x8f,0x11,0x84,0xb3,0x19,0x82,0x7c,0x46,0x2a,
+  0x56,0xaf,0xa3,0x46,0x49,0xcb,0x9d,0xeb,0x8d,0x2d,0x8f,0xc9,0x32,0x2b,0xb6,0x19,
+  0xa6,0x47,0x13,0x4b,0xdb,0x53,0xe2,0xe4,0xbf,0x90,0x1f,0xfd,0x40,0x1a,0x7e,0xa3,
+  0x40,0xaf,0x51,0xeb,0x78,0x13,0x53,0xde,0xef,0x26,0x52,0xbc,0x00,0x15,0x2d,0x1a,
+  0xb7,0x0e,0x26,0x71,0x63,0xcb,0x34,0x8b,0x41,0xe3,0x82,0x8f,0x1d,0xf0,0x8c,0x3e,
+  0xcc,0x74,0xd1,0x79,0x6f,0xf4,0xb8,0x25,0x35,0xb6,0x4e,0x50,0x89,0xed,0x60,0xdc,
+  0xf2,0x35,0x04,0xef,0x8a,0x21,0xe4,0xc2,0xeb,0x0b,0xd7,0x15,0x8d,0xc4,0xd2,0x9c,
+  0xc5,0xeb,0x32,0xe3,0x81,0x24,0xa4,0x39,0x5c,0x77,0x56,0xb3,0x32,0xc6,0xa3,0x24,
+  0xb6,0x00,0x45,0xa8,0x47,0x4b,0x62,0x83,0x06,0x0b,0xed,0x17,0x3d,0xc8,0x75,0xed,
+  0x8f,0x35,0x42,0x71,0x75,0x42,0x57,0x7b,0xc2,0xb4,0x9b,0x13,0xb2,0x2d,0xa2,0xe4,
+  0x3e,0x8e,0xb1,0x21,0xfa,0xbe,0x67,0x06,0x4d,0xdc,0x64,0x12,0xda,0x02,0xe5,0xce,
+  0xed,0x1a,0xb0,0x5c,0x17,0x85,0xe2,0xfa,0x8a,0x4e,0x44,0x41,0xff,0x8b,0x12,0x84,
+  0xb1,0x3c,0x68,0x08,0xc9,0x34,0xd6,0x70,0x27,0x46,0x88,0x2c,0x5d,0x66,0xed,0x14,
+  0x16,0x21,0xf7,0xf1,0x4d,0x2d,0x53,0x75,0x3a,0x4a,0x11,0x73,0x93,0xb8,0x94,0xdc,
+  0x5a,0xf0,0x9d,0xd5,0xa4,0x34,0xa2,0x6b,0x50,0xbe,0x0c,0x3d,0xf8,0x45,0x41,0x58,
+  0xfe,0xbc,0xf9,0x35,0x98,0x9c,0xdc,0x7d,0x3e,0x23,0x14,0x70,0x7b,0x81,0x75,0x4b,
+  0xf0,0x24,0x02,0xc4,0x12,0xa6,0x4c,0x6a,0x0d,0xf6,0xed,0xf9,0xe9,0xbb,0x9c,0xd2,
+  0x87,0xe6,0xae,0x36,0x7d,0xb4,0x76,0x73,0x3f,0x17,0x78,0x64,0xb6,0xeb,0x8c,0x63,
+  0x21,0x95,0xc2,0x28,0x63,0x13,0x91,0x9e,0xcc,0x64,0x95,0xf8,0xd5,0x41,0x4a,0x1c,
+  0xf8,0x73,0xd9,0x80,0xe9,0x7c,0x72,0xcf,0x3b,0x27,0x1e,0x2d,0xee,0x66,0xdf,0x26,
+  0xf4,0xd9,0x83,0xc2,0xa6,0x4c,0x28,0x29,0xae,0x92,0x89,0x39,0x81,0xf4,0x76,0x76,
+  0xcd,0x2d,0x09,0x7a,0x77,0x79,0x88,0x75,0x90,0x7e,0xca,0xe2,0x4e,0x24,0x89,0x2b,
+  0x36,0x8a,0x36,0x47,0xc2,0xdb,0x7b,0x7f,0xe9,0x07,0x24,0x74,0x80,0x2e,0x28,0x10,
+  0x9e,0xf0,0x88,0xc3,0xe8,0xfc,0xf9,0xc1,0xc1,0xc1,0x9c,0x5a,0x28,0x69,0x7a,0x42,
+  0x86,0xcc,0x61,0xbc,0x88,0x15,0x08,0x50,0xf0,0x29,0xbb,0xe6,0xaa,0x83,0x1c,0xf3,
+  0x10,0xa3,0xad,0x92,0x6f,0x70,0x2c,0x54,0x38,0x44,0x12,0xfa,0xa7,0xe9,0x48,0x29,
+  0x4b,0xa2,0x8d,0x27,0x43,0x53,0x71,0x52,0x6e,0xb7,0x1c,0x23,0x3f,0xe1,0xa8,0xd9,
+  0xa0,0xa1,0xeb,0x2c,0xbc,0xa4,0x69,0x3a,0x91,0xcc,0xee,0x40,0x39,0xb8,0x2d,0x00,
+  0x45,0x0b,0x83,0x8a,0x93,0x50,0x99,0xcf,0x1e,0x7f,0x6a,0x95,0xe1,0x25,0xce,0x07,
+  0x46,0x46,0xe7,0x7b,0x2e,0x3d,0x63,0xe8,0x35,0xba,0xbc,0xb6,0x00,0x1a,0x9d,0x1e,
+  0x92,0x52,0x92,0x9c,0x68,0xe8,0xc9,0x1b,0x94,0xed,0x6b,0x14,0x78,0x32,0x3d,0xc0,
+  0x28,0xf1,0x51,0x4c,0xcc,0x5f,0x07,0x7f,0x9f,0xcc,0xaa,0x92,0xf1,0x16,0x45,0x36,
+  0xa5,0x6f,0x1e,0x9f,0x0d,0xff,0x59,0x98,0x01,0xe9,0x96,0x0d,0x66,0x60,0x4e,0xb6,
+  0x53,0x31,0x22,0xdf,0xd4,0x76,0xe4,0xfc,0xe3,0xf4,0xdd,0x5b,0xec,0x82,0x8f,0x80,
+  0x73,0xdf,0x85,0x20,0x66,0xf8,0x8c,0x19,0x6d,0x71,0x06,0x6f,0x9c,0xc7,0xd9,0x28,
+  0x6a,0xae,0xd7,0xd1,0x8f,0xa9,0x9a,0x63,0x2e,0x83,0x61,0x34,0x3b,0x0b,0x66,0x79,
+  0xfe,0x82,0xec,0xed,0x05,0x64,0x16,0x8e,0x75,0x2e,0xcf,0xb1,0x3c,0xc1,0x34,0x10,
+  0x5e,0x96,0xf9,0x6f,0x67,0xef,0x7f,0x67,0x38,0x50,0x1d,0x8c,0x27,0x5d,0x6b,0xb4,
+  0x83,0x73,0x6c,0xa7,0x41,0x65,0x97,0x65,0xd8,0xc4,0xb1,0x9b,0xe7,0x87,0xe1,0xdc,
+  0xc3,0x64,0x86,0x21,0x4d,0xa4,0xc3,0x42,0xe0,0x0c,0x75,0xae,0xea,0x14,0x23,0x1f,
+  0xa1,0xc0,0xa9,0x10,0x52,0x4c,0xe7,0x87,0x07,0x51,0x0a,0xf7,0x79,0xfd,0x42,0x00,
+  0xd8,0x07,0xb3,0x3b,0x12,0x6a,0x46,0x64,0x45,0x1e,0x32,0x3d,0xdf,0x66,0x7a,0x55,
+  0x83,0xb8,0xfa,0x52,0x07,0x84,0xeb,0x92,0x78,0xbb,0x21,0x7c,0xcd,0xf1,0x55,0x88,
+  0x49,0x1d,0xe8,0xc8,0x28,0xbd,0x09,0x7a,0x87,0xcb,0x15,0xc7,0xd2,0x94,0x74,0x3f,
+  0x50,0x4a,0x0f,0xcd,0x4b,0x4a,0x12,0xba,0x3f,0xde,0xec,0xa3,0x7f,0xf4,0x98,0x32,
+  0x9a,0xce,0xef,0x65,0x8c,0xcd,0x84,0x7f,0x43,0x15,0xba,0xa8,0x21,0x2c,0x46,0x6b,
+  0x0d,0x46,0xe6,0xdc,0xc3,0x22,0xc0,0x58,0x05,0x18,0x5b,0xe6,0x95,0x69,0x50,0xc4,
+  0x61,0x50,0xa7,0x64,0x87,0x0c,0x09,0xdd,0x3f,0xe5,0xbe,0x66,0x95,0x32,0xd8,0xd7,
+  0x78,0x08,0xb7,0xa1,0xfc,0x1e,0x03,0xc9,0x80,0x79,0xe3,0xb9,0x4a,0xf7,0xe9,0x77,
+  0x8f,0xf4,0x79,0x37,0xe9,0x01,0xac,0x35,0xf6,0x0b,0x11,0x7c,0x25,0xda,0x01,0x62,
+  0x08,0x67,0x3a,0x8f,0x82,0x4c,0x86,0x57,0x2f,0x66,0x6d,0x78,0xe7,0xbe,0x8c,0xaf,
+  0x2a,0xba,0x1f,0xc5,0x1b,0xd6,0x38,0x4c,0x6c,0x54,0x68,0xd4,0x50,0x50,0x70,0x55,
+  0x06,0x17,0xf0,0xb7,0xfb,0x83,0x26,0x8c,0x6f,0x87,0xf3,0xbb,0x93,0x8f,0x47,0x6f,
+  0x76,0xe9,0xb2,0x9a,0xe3,0x77,0x9b,0xc5,0x4f,0x97,0xad,0x4f,0x94,0xe1,0xdb,0xe4,
+  0x3f,0x63,0xe6,0x2f,0xba,0x5b,0x0a,0x00,0x00,
+};
+
+#endif  // _HTMLS_GZ_H
@@ -28,6 +28,8 @@
 #include "server.h"
 #include <FS.h>
 #include "espconnect.h"
+#include "connpool.h"
+#include "relaytrace.h"
 
 char ether_buffer[ETHER_BUFFER_SIZE];
 unsigned long getNtpTime();
@@ -36,6 +38,10 @@ void reset_all_stations_immediate();
 void push_message(byte type, uint32_t lval=0, float fval=0.f, const char* sval=NULL);
 void manual_start_program(byte, byte);
 void httpget_callback(byte, uint16_t, uint16_t);
+void sse_post(byte type, ulong lval=0, ulong ival=0);
+void sse_loop();
+void server_job_loop();
+void server_scan_loop();
 
 
 // Small variations have been added to the timing values below
@@ -387,11 +393,15 @@ void do_loop() {
         wifi_server->handleClient();
         connecting_timeout = 0;
       } else {
+        connpool_close_all();
         os.state = OS_STATE_INITIAL;
       }
     }
     break;
   }
+  server_job_loop();
+  server_scan_loop();
+  sse_loop();
   ui_state_machine();
   // Process Ethernet packets
 
@@ -421,10 +431,12 @@ void do_loop() {
         // rain delay started, record time
         os.raindelay_start_time = curr_time;
         push_message(IFTTT_RAINSENSOR, LOGDATA_RAINDELAY, 1);
+        sse_post(IFTTT_RAINSENSOR, LOGDATA_RAINDELAY, 1);
       } else {
         // rain delay stopped, write log
         write_log(LOGDATA_RAINDELAY, curr_time);
         push_message(IFTTT_RAINSENSOR, LOGDATA_RAINDELAY, 0);
+        sse_post(IFTTT_RAINSENSOR, LOGDATA_RAINDELAY, 0);
       }
       os.old_status.rain_delayed = os.status.rain_delayed;
     }
@@ -437,6 +449,7 @@ void do_loop() {
           // rain sensor on, record time
           os.sensor_lasttime = curr_time;
           push_message(IFTTT_RAINSENSOR, LOGDATA_RAINSENSE, 1);
+          sse_post(IFTTT_RAINSENSOR, LOGDATA_RAINSENSE, 1);
         } else {
           // rain sensor off, write log
           if (curr_time>os.sensor_lasttime+10) {  // add a 10 second threshold
@@ -445,6 +458,7 @@ void do_loop() {
             write_log(LOGDATA_RAINSENSE, curr_time);
             push_message(IFTTT_RAINSENSOR, LOGDATA_RAINSENSE, 0);
           }
+          sse_post(IFTTT_RAINSENSOR, LOGDATA_RAINSENSE, 0);
         }
         os.old_status.rain_sensed = os.status.rain_sensed;
       }
@@ -506,7 +520,10 @@ void do_loop() {
               }// if water_time
             }// if prog.durations[sid]
           }// for sid
-          if(match_found) push_message(IFTTT_PROGRAM_SCHED, pid, prog.use_weather?os.options[OPTION_WATER_PERCENTAGE]:100);
+          if(match_found) {
+            push_message(IFTTT_PROGRAM_SCHED, pid, prog.use_weather?os.options[OPTION_WATER_PERCENTAGE]:100);
+            sse_post(IFTTT_PROGRAM_SCHED, pid, prog.use_weather?os.options[OPTION_WATER_PERCENTAGE]:100);
+          }
         }// if check_match
       }// for pid
 
@@ -557,6 +574,8 @@ void do_loop() {
           if (pd.station_qid[sid]==255) continue;
 
           q = pd.queue + pd.station_qid[sid];
+          // testing stations (/cm) are assigned program index 99
+          relaytrace_cause = (q->pid==99) ? RELAY_CAUSE_MANUAL : RELAY_CAUSE_PROGRAM;
           // check if this station is scheduled, either running or waiting to run
           if (q->st > 0) {
             // if so, check if we should turn it off
@@ -618,6 +637,7 @@ void do_loop() {
       // reset all stations
       if (!pd.nqueue) {
         // turn off all stations
+        relaytrace_cause = RELAY_CAUSE_PROGRAM;
         os.clear_all_station_bits();
         os.apply_all_station_bits();
         // reset runtime
@@ -636,6 +656,8 @@ void do_loop() {
       }
     }//if_some_program_is_running
 
+    // master stations follow the stations that activate them
+    relaytrace_cause = RELAY_CAUSE_PROGRAM;
     // handle master
     if (os.status.mas>0) {
       int16_t mas_on_adj = water_time_decode_signed(os.options[OPTION_MASTER_ON_ADJ]);
@@ -736,6 +758,9 @@ void do_loop() {
     if (curr_time && (curr_time % CHECK_NETWORK_INTERVAL==0))  os.status.req_network = 1;
     check_network();
 
+    // close idle keep-alive connections to remote controllers
+    connpool_expire();
+
     // check weather
     check_weather();
 
@@ -747,6 +772,7 @@ void do_loop() {
         push_message(IFTTT_WEATHER_UPDATE, (wuf&WEATHER_UPDATE_EIP)?os.nvdata.external_ip:0,
                                          (wuf&WEATHER_UPDATE_WL)?os.options[OPTION_WATER_PERCENTAGE]:-1);
       }
+      sse_post(IFTTT_WEATHER_UPDATE);
       os.weather_update_flag = 0;
     }
     static byte reboot_notification = 1;
@@ -836,6 +862,7 @@ void process_dynamic_events(ulong curr_time) {
   }
 
   byte sid, s, bid, qid, rbits;
+  relaytrace_cause = en ? RELAY_CAUSE_RAIN : RELAY_CAUSE_DISABLE;
   for(bid=0;bid<os.nboards;bid++) {
     rbits = os.station_attrib_bits_read(ADDR_NVM_IGNRAIN+bid);
     for(s=0;s<8;s++) {
@@ -920,6 +947,7 @@ void schedule_all_stations(ulong curr_time) {
  * No log records will be written
  */
 void reset_all_stations_immediate() {
+  relaytrace_cause = RELAY_CAUSE_RESET;
   os.clear_all_station_bits();
   os.apply_all_station_bits();
   pd.reset_runtime();
@@ -954,6 +982,7 @@ void manual_start_program(byte pid, byte uwt) {
   if ((pid>0)&&(pid<255)) {
     pd.read(pid-1, &prog);
     push_message(IFTTT_PROGRAM_SCHED, pid-1, uwt?os.options[OPTION_WATER_PERCENTAGE]:100, "");
+    sse_post(IFTTT_PROGRAM_SCHED, pid-1, uwt?os.options[OPTION_WATER_PERCENTAGE]:100);
   }
   for(sid=0;sid<os.nstations;sid++) {
     bid=sid>>3;
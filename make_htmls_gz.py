@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+#
+# Generate htmls_gz.h from htmls.h
+# Each page in htmls.h is stored gzip-compressed as <name>_gz, so the
+# web server can send it straight from flash with Content-Encoding: gzip.
+# Run this after editing htmls.h (make.lin30 does it automatically).
+#
+# This file is part of the OpenSprinkler library
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+import gzip
+import os
+import re
+import sys
+
+here = os.path.dirname(os.path.abspath(__file__))
+src = os.path.join(here, 'htmls.h')
+dst = os.path.join(here, 'htmls_gz.h')
+
+with open(src, newline='') as f:
+  text = f.read()
+
+pages = re.findall(r'const char (\w+)\[\] PROGMEM = R"\((.*?)\)";', text, re.S)
+if not pages:
+  sys.exit('no pages found in ' + src)
+
+out = ['/* Generated by make_htmls_gz.py from htmls.h, do not edit */',
+       '',
+       '#ifndef _HTMLS_GZ_H',
+       '#define _HTMLS_GZ_H',
+       '']
+for name, html in pages:
+  # the compiler reads the raw strings with \n line ends
+  html = html.replace('\r\n', '\n').encode()
+  data = gzip.compress(html, 9, mtime=0)
+  out.append('// %s: %d bytes, %d compressed' % (name, len(html), len(data)))
+  out.append('const uint8_t %s_gz[] PROGMEM = {' % name)
+  for i in range(0, len(data), 16):
+    out.append('  ' + ','.join('0x%02x' % b for b in data[i:i+16]) + ',')
+  out.append('};')
+  out.append('')
+out.append('#endif  // _HTMLS_GZ_H')
+
+with open(dst, 'w', newline='\n') as f:
+  f.write('\n'.join(out) + '\n')
@@ -106,6 +106,7 @@ void ProgramData::save_count() {
 void ProgramData::eraseall() {
   nprograms = 0;
   save_count();
+  os.data_changed(DATA_GEN_PROGRAMS);
 }
 
 /** Read a program from NVM*/
@@ -130,6 +131,7 @@ byte ProgramData::add(ProgramStruct *buf) {
     nprograms ++;
     save_count();
   }
+  os.data_changed(DATA_GEN_PROGRAMS);
   return 1;
 }
 
@@ -152,6 +154,7 @@ void ProgramData::moveup(byte pid) {
     }
     // NVM write
   }
+  os.data_changed(DATA_GEN_PROGRAMS);
 }
 
 /** Modify a program */
@@ -163,6 +166,7 @@ byte ProgramData::modify(byte pid, ProgramStruct *buf) {
     unsigned int addr = ADDR_PROGRAMDATA + (unsigned int)pid * PROGRAMSTRUCT_SIZE;
     nvm_write_block((const void*)buf, (void *)addr, PROGRAMSTRUCT_SIZE);
   }
+  os.data_changed(DATA_GEN_PROGRAMS);
   return 1;
 }
 
@@ -183,6 +187,7 @@ byte ProgramData::del(byte pid) {
     nprograms --;
     save_count();
   }
+  os.data_changed(DATA_GEN_PROGRAMS);
   return 1;
 }
 
@@ -333,6 +338,7 @@ byte ProgramData::set_flagbit(byte pid, byte bid, byte value) {
     else flag&=(~(1<<bid));
     nvm_write_byte((const byte *)addr, flag);
   }
+  os.data_changed(DATA_GEN_PROGRAMS);
   return 1;  
 }
 
@@ -0,0 +1,82 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Relay actuation trace
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <FS.h>
+#include "relaytrace.h"
+
+const char trace_filename[] PROGMEM = RELAY_TRACE_FILENAME;
+
+byte relaytrace_cause = RELAY_CAUSE_PROGRAM;
+
+static RelayTraceRecord trace[RELAY_TRACE_SIZE];
+// sequence number of the next record, only ever incremented after
+// the record has been written, so readers never see a partial record
+static volatile ulong trace_head = 0;
+
+/** Record a relay change
+ * This is called for every station on/off change,
+ * so it must stay cheap and must not allocate.
+ */
+void relaytrace_add(byte sid, byte state) {
+  RelayTraceRecord *rec = trace + (trace_head & (RELAY_TRACE_SIZE-1));
+  rec->ms = millis();
+  rec->sid = sid;
+  rec->state = state;
+  rec->cause = relaytrace_cause;
+  trace_head++;
+}
+
+ulong relaytrace_head() {
+  return trace_head;
+}
+
+/** Copy record seq into rec
+ * Returns false if the record has not been written yet
+ * or has already been overwritten
+ */
+bool relaytrace_get(ulong seq, RelayTraceRecord *rec) {
+  if(seq>=trace_head || trace_head-seq>RELAY_TRACE_SIZE) return false;
+  *rec = trace[seq & (RELAY_TRACE_SIZE-1)];
+  // the record may have been overwritten while being copied
+  return trace_head-seq<=RELAY_TRACE_SIZE;
+}
+
+/** Write the trace to flash
+ * One record per line: ms,sid,state,cause
+ * The previous dump is overwritten.
+ */
+bool relaytrace_dump() {
+  char fn[16];
+  char line[32];
+  strcpy_P(fn, trace_filename);
+  File f = SPIFFS.open(fn, "w");
+  if(!f) return false;
+  RelayTraceRecord rec;
+  ulong head = trace_head;
+  ulong seq = (head>RELAY_TRACE_SIZE) ? head-RELAY_TRACE_SIZE : 0;
+  for(;seq<head;seq++) {
+    if(!relaytrace_get(seq, &rec)) continue;
+    int n = snprintf(line, sizeof(line), "%lu,%d,%d,%d\n", rec.ms, rec.sid, rec.state, rec.cause);
+    f.write((byte*)line, n);
+  }
+  f.close();
+  return true;
+}
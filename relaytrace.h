@@ -0,0 +1,51 @@
+/* OpenSprinkler Unified (AVR/RPI/BBB/LINUX/ESP8266) Firmware
+ *
+ * Relay actuation trace header file
+ *
+ * This file is part of the OpenSprinkler library
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RELAYTRACE_H
+#define _RELAYTRACE_H
+
+#include "defines.h"
+
+#define RELAY_TRACE_SIZE      64   // number of records kept in RAM (must be a power of 2)
+
+/** Relay change causes */
+#define RELAY_CAUSE_PROGRAM   0    // started or stopped by a program (incl. master stations)
+#define RELAY_CAUSE_MANUAL    1    // manual station run (/cm)
+#define RELAY_CAUSE_RAIN      2    // stopped by rain delay or rain sensor
+#define RELAY_CAUSE_DISABLE   3    // stopped because the controller is disabled
+#define RELAY_CAUSE_RESET     4    // stopped by a reset of all stations
+
+/** Relay trace record */
+struct RelayTraceRecord {
+  ulong ms;     // time of the change (millis)
+  byte  sid;    // station index
+  byte  state;  // new station state (0/1)
+  byte  cause;  // cause of the change (RELAY_CAUSE_*)
+};
+
+extern byte relaytrace_cause;  // cause of the relay changes being made, set by the caller
+
+void relaytrace_add(byte sid, byte state);  // record a relay change
+ulong relaytrace_head();                    // sequence number of the next record
+bool relaytrace_get(ulong seq, RelayTraceRecord *rec); // copy record seq (false if not available)
+bool relaytrace_dump();                     // write the trace to flash
+
+#endif  // _RELAYTRACE_H
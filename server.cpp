@@ -28,12 +28,13 @@
 // External variables defined in main ion file
 #include <FS.h>
 #include "espconnect.h"
+#include "relaytrace.h"
 #define INSERT_DELAY(x) {}
 #include <time.h>    
 extern ESP8266WebServer *wifi_server;
 extern char ether_buffer[];
 
-#define handle_return(x) {if(x==HTML_OK) server_send_html(ether_buffer); else server_send_result(x); return;}
+#define handle_return(x) {if(query_batch) return_code=(x); else if((x)==HTML_OK) send_ether_buffer(); else server_send_result((x)); return;}
 
 extern char tmp_buffer[];
 extern OpenSprinkler os;
@@ -42,6 +43,37 @@ extern ulong flow_count;
 
 static byte return_code;
 static char* get_buffer = NULL;
+static bool ether_streaming = false;  // part of the response has already been sent out
+static bool ether_chunked = false;    // the streamed response uses chunked transfer encoding
+static bool ether_etag = false;       // the response has an ETag, so clients may keep it and revalidate
+static bool ether_cbor = false;       // the response is CBOR encoded (binary)
+static bool ether_json = false;       // the response is JSON (print_json_header)
+static char* query_batch = NULL;      // query string of the /cb command being run (NULL: use the request)
+static bool server_dry_run = false;   // check the request without applying it (/cb)
+// state as it would be after the /cb commands checked so far
+static byte dry_nprograms;            // number of programs
+static byte dry_nqueue;               // queue elements in use
+static byte dry_queued[MAX_NUM_STATIONS/8];  // stations given a new queue element (bits)
+static uint32_t dry_gpio_pins;        // pins taken by GPIO stations (bits)
+
+#if defined(ENABLE_SERVER_METRICS)
+#if !(defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3))
+// older cores have no fragmentation figures in EspClass, they are read from the allocator
+extern "C" {
+#include "umm_malloc/umm_malloc.h"
+}
+#define UMM_BLOCK_BYTES 8
+#endif
+static ulong metrics_bytes = 0;       // response bytes of the request being served
+static bool metrics_error = false;    // the request being served has failed
+static byte metrics_current = 0;      // metric of the request being served
+void metrics_add_bytes(byte id, ulong n);
+  #define METRICS_BYTES(n)  (metrics_bytes += (n))
+  #define METRICS_ERROR()   (metrics_error = true)
+#else
+  #define METRICS_BYTES(n)  {}
+  #define METRICS_ERROR()   {}
+#endif
 
 BufferFiller bfill;
 
@@ -56,11 +88,11 @@ void delete_log(char *name);
 void reset_all_stations_immediate();
 void reset_all_stations();
 void make_logfile_name(char *name);
-
-/* Check available space (number of bytes) in the Ethernet buffer */
-int available_ether_buffer() {
-  return ETHER_BUFFER_SIZE - (int)bfill.position();
-}
+typedef void (*URLHandler)(void);
+unsigned char h2int(char c);
+void urlDecode(char *urlbuf);
+void server_cbor_programs_main(CBORWriter &w);
+bool server_cbor_log_record(CBORWriter &w, char *line);
 
 // Define return error code
 #define HTML_OK                0x00
@@ -114,10 +146,217 @@ void print_html_standard_header() {
 }
 
 void print_json_header(bool bracket=true) {
-  wifi_server->sendHeader("Cache-Control", "max-age=0, no-cache, no-store, must-revalidate");
-  wifi_server->sendHeader("Content-Type", "application/json");
+  wifi_server->sendHeader("Cache-Control", ether_etag ? "no-cache" : "max-age=0, no-cache, no-store, must-revalidate");
+  // the content type is given when the response is sent (see ether_content_type)
+  ether_json = true;
   wifi_server->sendHeader("Access-Control-Allow-Origin", "*");
-  if(bracket) bfill.emit_p(PSTR("{"));
+  if(bracket && !ether_cbor) bfill.emit_p(PSTR("{"));
+}
+
+/** Content negotiation
+ * /ja, /jp and /jl are sent CBOR encoded to clients that accept application/cbor
+ * vary: add the Vary header to the response (a response job writes its own headers,
+ * and a header the web server never sends would be left over for the next response)
+ */
+bool server_accepts_cbor(bool vary=true) {
+  if(vary) wifi_server->sendHeader("Vary", "Accept");
+  ether_cbor = strstr(wifi_server->header("Accept").c_str(), "application/cbor")!=NULL;
+  return ether_cbor;
+}
+
+/** Query table
+ * The arguments of a request are indexed once per request (query_parse) into a
+ * fixed table of slots, one slot per known key, so that looking up a key does
+ * not scan all arguments. Known keys are
+ * - numbered keys: a letter followed by an index: o<oid> (options),
+ *   s<sid> (station names) and m/i/n/d/q/p<bid> (station attributes)
+ * - named keys, placed by a perfect hash that is verified at compile time
+ */
+#define QUERY_HASH_SIZE   49  // number of slots for named keys
+#define QUERY_ATTRIB_KEYS "minqdp"
+
+constexpr const char* query_keys[] = {
+  "pw", "ap", "cpw", "day", "dump", "en", "end", "hist", "ifkey", "jsp", "loc",
+  "name", "npw", "pid", "rbt", "rd", "re", "rsn", "sd", "sid", "since", "st",
+  "start", "t", "tkn", "ttt", "type", "uwt", "wsp", "wtkey", "wto", "v"
+};
+#define QUERY_NUM_KEYS  (sizeof(query_keys)/sizeof(query_keys[0]))
+
+constexpr byte query_key_len(const char *k) {
+  return *k ? 1+query_key_len(k+1) : 0;
+}
+
+constexpr byte query_key_hash(const char *k) {
+  return (9*(byte)k[0] + 18*(byte)(k[0]?k[1]:0) + 29*(byte)k[query_key_len(k)-1] + query_key_len(k)) % QUERY_HASH_SIZE;
+}
+
+constexpr bool query_hash_unique(unsigned i, unsigned j) {
+  return j>=QUERY_NUM_KEYS || (query_key_hash(query_keys[i])!=query_key_hash(query_keys[j]) && query_hash_unique(i, j+1));
+}
+
+constexpr bool query_hash_perfect(unsigned i=0) {
+  return i>=QUERY_NUM_KEYS || (query_hash_unique(i, i+1) && query_hash_perfect(i+1));
+}
+
+static_assert(query_hash_perfect(), "query key hash has collisions, adjust QUERY_HASH_SIZE or the multipliers");
+
+#define QUERY_SLOT_OPTION  QUERY_HASH_SIZE
+#define QUERY_SLOT_SNAME   (QUERY_SLOT_OPTION+NUM_OPTIONS)
+#define QUERY_SLOT_ATTRIB  (QUERY_SLOT_SNAME+MAX_NUM_STATIONS)
+#define QUERY_NUM_SLOTS    (QUERY_SLOT_ATTRIB+(sizeof(QUERY_ATTRIB_KEYS)-1)*(MAX_EXT_BOARDS+1))
+
+static byte query_slots[QUERY_NUM_SLOTS];   // argument index+1 of each slot (0: not present)
+static byte query_named[QUERY_HASH_SIZE];   // named key index+1 of each named slot (0: unused)
+
+/** Slot of a key, or -1 if the key is not a known key */
+static int query_slot(const char *key) {
+  byte len = strlen(key);
+  if(!len) return -1;
+  // numbered keys
+  if(len>1 && len<4 && key[1]>='0' && key[1]<='9' && (len==2 || (key[2]>='0' && key[2]<='9'))) {
+    int idx = atoi(key+1);
+    if(key[0]=='o') return (idx<NUM_OPTIONS) ? QUERY_SLOT_OPTION+idx : -1;
+    if(key[0]=='s') return (idx<MAX_NUM_STATIONS) ? QUERY_SLOT_SNAME+idx : -1;
+    const char *a = strchr(QUERY_ATTRIB_KEYS, key[0]);
+    if(a && idx<=MAX_EXT_BOARDS) return QUERY_SLOT_ATTRIB+(a-QUERY_ATTRIB_KEYS)*(MAX_EXT_BOARDS+1)+idx;
+  }
+  // named keys
+  byte h = query_key_hash(key);
+  byte k = query_named[h];
+  if(k && !strcmp(key, query_keys[k-1])) return h;
+  return -1;
+}
+
+/** Index the arguments of the current request */
+void query_parse() {
+  if(!query_named[query_key_hash(query_keys[0])]) {
+    // first call: build the reverse map of the named slots
+    for(byte k=0;k<QUERY_NUM_KEYS;k++) query_named[query_key_hash(query_keys[k])] = k+1;
+  }
+  memset(query_slots, 0, sizeof(query_slots));
+  int n = wifi_server->args();
+  for(int i=0;i<n && i<255;i++) {
+    int slot = query_slot(wifi_server->argName(i).c_str());
+    // like hasArg, the first occurrence of a key wins
+    if(slot>=0 && !query_slots[slot])  query_slots[slot] = i+1;
+  }
+}
+
+/** JSON section cache
+ * The programs, options and stations sections of /jp, /jo, /jn and /ja are
+ * rarely changed but costly to build (NVM reads), so their serialised JSON
+ * is kept in RAM. A cached section is rebuilt only when the data generations
+ * it depends on have changed. Sections that do not fit are built live.
+ */
+#define JSON_SECTION_PROGRAMS  0
+#define JSON_SECTION_OPTIONS   1
+#define JSON_SECTION_STATIONS  2
+#define NUM_JSON_SECTIONS      3
+#define JSON_CACHE_SIZE        2048
+
+void server_json_programs_main();
+void server_json_options_main();
+void server_json_stations_main();
+
+struct JSONSection {
+  ulong gen;        // data generation the cached JSON was built from
+  ulong extra;      // anything else the section depends on
+  uint16_t offset;  // position in json_cache
+  uint16_t len;     // length (0: not cached)
+};
+
+static char json_cache[JSON_CACHE_SIZE];
+static JSONSection json_sections[NUM_JSON_SECTIONS];
+
+/** Data generation a section is built from */
+ulong json_section_gen(byte sec) {
+  switch(sec) {
+  case JSON_SECTION_PROGRAMS:
+    return os.data_gens[DATA_GEN_PROGRAMS]+os.data_gens[DATA_GEN_OPTIONS];  // nboards is an option
+  case JSON_SECTION_STATIONS:
+    return os.data_gens[DATA_GEN_STATIONS]+os.data_gens[DATA_GEN_OPTIONS];
+  default:
+    return os.data_gens[DATA_GEN_OPTIONS];
+  }
+}
+
+/** Anything other than the data generation a section depends on */
+ulong json_section_extra(byte sec) {
+  switch(sec) {
+  case JSON_SECTION_PROGRAMS:
+    return os.now_tz()/86400L;  // interval programs are output relative to today
+  case JSON_SECTION_STATIONS:
+    return os.status.has_sd;
+  default:
+    return 0;
+  }
+}
+
+/** Remove a section from the cache, moving the sections after it down */
+static void json_cache_drop(byte sec) {
+  JSONSection *c = json_sections+sec;
+  if(!c->len) return;
+  uint16_t used = 0;
+  for(byte i=0;i<NUM_JSON_SECTIONS;i++) {
+    JSONSection *o = json_sections+i;
+    if(o->len && o->offset+o->len>used) used = o->offset+o->len;
+  }
+  memmove(json_cache+c->offset, json_cache+c->offset+c->len, used-c->offset-c->len);
+  for(byte i=0;i<NUM_JSON_SECTIONS;i++) {
+    JSONSection *o = json_sections+i;
+    if(o->len && o->offset>c->offset) o->offset -= c->len;
+  }
+  c->len = 0;
+}
+
+/** Output a JSON section, from the cache if it is current */
+void server_json_section(byte sec) {
+  static void (* const mains[NUM_JSON_SECTIONS])() = {server_json_programs_main, server_json_options_main, server_json_stations_main};
+  JSONSection *c = json_sections+sec;
+  ulong gen = json_section_gen(sec);
+  ulong extra = json_section_extra(sec);
+  if(!c->len || c->gen!=gen || c->extra!=extra) {
+    json_cache_drop(sec);
+    uint16_t used = 0;
+    for(byte i=0;i<NUM_JSON_SECTIONS;i++) {
+      JSONSection *o = json_sections+i;
+      if(o->len && o->offset+o->len>used) used = o->offset+o->len;
+    }
+    // build the section into the free part of the cache
+    BufferFiller out = bfill;
+    bfill = BufferFiller(json_cache+used, JSON_CACHE_SIZE-used);
+    mains[sec]();
+    bool fits = !bfill.overflow();
+    uint16_t len = bfill.position();
+    bfill = out;
+    if(!fits) {
+      mains[sec]();
+      return;
+    }
+    c->gen = gen;
+    c->extra = extra;
+    c->offset = used;
+    c->len = len;
+  }
+  bfill.emit_mem(json_cache+c->offset, c->len);
+}
+
+/** Conditional GET
+ * The ETag of a response is made of the boot id and the generation(s) of the data
+ * the response is built from, plus anything else the response depends on (extra).
+ * Returns true if the client's copy is still current, in which case 304 has been sent.
+ */
+bool server_not_modified(ulong gen, ulong extra=0) {
+  char etag[32];
+  snprintf(etag, sizeof(etag), "\"%lx-%lx-%lx%s\"", os.boot_id, gen, extra, ether_cbor?"c":"");
+  wifi_server->sendHeader("ETag", etag);
+  ether_etag = true;
+  if(wifi_server->header("If-None-Match") == etag) {
+    wifi_server->sendHeader("Cache-Control", "no-cache");
+    wifi_server->send(304);
+    return true;
+  }
+  return false;
 }
 
 byte findKeyVal (const char *str,char *strbuf, uint8_t maxlen,const char *key,bool key_in_pgm=false,uint8_t *keyfound=NULL)
@@ -125,13 +364,43 @@ byte findKeyVal (const char *str,char *strbuf, uint8_t maxlen,const char *key,bo
   uint8_t found=0;
   // for ESP8266: there are two cases:
   // case 1: if str is NULL, we assume the key-val to search is already parsed in wifi_server
+  // (or, while /cb runs a command, in the command's query string)
+  if(str==NULL && query_batch) {
+    char _key[10];
+    if(key_in_pgm) strcpy_P(_key, key);
+    else strcpy(_key, key);
+    byte klen = strlen(_key);
+    strbuf[0]=0;
+    for(const char *q=query_batch;q;q=strchr(q, '&')) {
+      if(*q=='&') q++;
+      if(strncmp(q, _key, klen) || q[klen]!='=') continue;
+      // copy and decode the value, as the web server does for request arguments
+      q += klen+1;
+      uint8_t i=0;
+      while(*q && *q!='&' && i<maxlen-1) strbuf[i++] = *q++;
+      strbuf[i]=0;
+      urlDecode(strbuf);
+      found=1;
+      break;
+    }
+    if (keyfound) *keyfound = found;
+    return strlen(strbuf);
+  }
   if(str==NULL) {
     char _key[10];
     if(key_in_pgm) strcpy_P(_key, key);
     else strcpy(_key, key);
-    if(wifi_server->hasArg(_key)) {
+    int slot = query_slot(_key);
+    int idx = -1;
+    if(slot>=0) {
+      idx = (int)query_slots[slot]-1;
+    } else if(wifi_server->hasArg(_key)) {
+      // keys that are not in the query table are looked up the slow way
+      for(idx=0;strcmp(wifi_server->argName(idx).c_str(), _key);idx++);
+    }
+    if(idx>=0) {
       // copy value to buffer, and make sure it ends properly
-      strncpy(strbuf, wifi_server->arg(_key).c_str(), maxlen);
+      strncpy(strbuf, wifi_server->arg(idx).c_str(), maxlen);
       strbuf[maxlen-1]=0;
       found=1;
     } else {
@@ -198,18 +467,62 @@ byte findKeyVal (const char *str,char *strbuf, uint8_t maxlen,const char *key,bo
   return(i);
 }
 
+/** Flush callback of bfill
+ * Responses that fit in ether_buffer are sent in one go by send_ether_buffer.
+ * Once a response outgrows the buffer, the first flush starts the response
+ * with unknown content length, and the buffer is then streamed out in full-size chunks.
+ * HTTP/1.1 clients get chunked transfer encoding, so the end of the response
+ * is marked by the terminating chunk and the connection can stay open.
+ */
+/** Content type of the response in ether_buffer */
+static const char* ether_content_type() {
+  return ether_cbor ? "application/cbor" : (ether_json ? "application/json" : "text/html");
+}
+
+void stream_ether_buffer(const char *data, unsigned int len) {
+  if(!ether_streaming) {
+#if defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3)
+    // returns false for HTTP/1.0 clients, which get a response that ends when the connection closes
+    ether_chunked = wifi_server->chunkedResponseModeStart(200, ether_content_type());
+#else
+    // the web server switches to chunked encoding by itself for HTTP/1.1 clients
+    wifi_server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    wifi_server->send(200, ether_content_type(), "");
+    ether_chunked = false;  // the HTTP version is not exposed, so always close at the end
+#endif
+    ether_streaming = true;
+  }
+  // sendContent_P works on RAM data as well and avoids a String copy
+  METRICS_BYTES(len);
+  wifi_server->sendContent_P(data, len);
+}
+
 void rewind_ether_buffer() {
-  bfill = ether_buffer;
+  bfill = BufferFiller(ether_buffer, ETHER_BUFFER_SIZE, stream_ether_buffer);
+  ether_streaming = false;
 }
 
-void send_packet(bool final=false) {
-  if(final || available_ether_buffer()<250) {
-    wifi_server->sendContent(ether_buffer);
-    if(final)
-      wifi_server->client().stop();      
-    else
-      rewind_ether_buffer();
+/** Send out the response in ether_buffer
+ * If part of the response has been streamed out already, send the rest and end the response
+ */
+void send_ether_buffer() {
+  if(!ether_streaming) {
+    // sent by length straight from the buffer: no String copy, and CBOR data may contain 0 bytes
+    METRICS_BYTES(bfill.position());
+    wifi_server->send_P(200, ether_content_type(), ether_buffer, bfill.position());
+    return;
+  }
+  bfill.flush();
+#if defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3)
+  if(ether_chunked) {
+    wifi_server->chunkedResponseFinalize();  // terminating chunk, the connection stays open
+    return;
   }
+#else
+  wifi_server->sendContent("");  // terminating chunk (if chunked)
+#endif
+  // without chunked encoding, closing the connection marks the end of the response
+  wifi_server->client().stop();
 }
 
 /** Convert a single hex digit character to its integer value */
@@ -245,39 +558,35 @@ void urlDecode (char *urlbuf)
     *dst = '\0';
 }
 
-String two_digits(uint8_t x) {
-  return String(x/10) + (x%10);
-}
-
-String toHMS(ulong t) {
-  return two_digits(t/3600)+":"+two_digits((t/60)%60)+":"+two_digits(t%60);
-}
-
-void server_send_html(String html) {
-  wifi_server->send(200, "text/html", html);
+/** Send a page stored gzip-compressed in flash (see htmls_gz.h)
+ * send_P writes it out directly, without copying it to RAM.
+ */
+void server_send_gz(const uint8_t *page, size_t len) {
+  METRICS_BYTES(len);
+  wifi_server->sendHeader("Content-Encoding", "gzip");
+  wifi_server->send_P(200, PSTR("text/html"), (PGM_P)page, len);
 }
 
-void server_send_json(String json) {
-  wifi_server->send(200, "application/json", json);
-}
+#define RESULT_BUFFER_SIZE 48
 
-void server_send_result(byte code) {
-  String html = F("{\"result\":");
-  html += code;
-  html += "}";
+/** Send a result code, and the name of the offending item if given
+ * The response is built in a stack buffer, so ether_buffer is left alone
+ * and nothing is allocated.
+ */
+void server_send_result(byte code, const char* item) {
+  if(code!=HTML_SUCCESS) METRICS_ERROR();
+  char buf[RESULT_BUFFER_SIZE];
+  BufferFiller f(buf, RESULT_BUFFER_SIZE);
+  f.emit_p(PSTR("{\"result\":$D"), code);
+  if(item) f.emit_p(PSTR(",\"item\":\"$J\""), item);
+  f.emit_p(PSTR("}"));
   print_html_standard_header();
-  server_send_json(html);
+  METRICS_BYTES(f.position());
+  wifi_server->send_P(200, PSTR("application/json"), buf, f.position());
 }
 
-void server_send_result(byte code, const char* item) {
-  String html = F("{\"result\":");
-  html += code;
-  html += F(",\"item\":\"");
-  if(item) html += item;
-  html += "\"";
-  html += "}";
-  print_json_header();
-  server_send_json(html);
+void server_send_result(byte code) {
+  server_send_result(code, NULL);
 }
 
 bool get_value_by_key(const char* key, long& val) {
@@ -298,73 +607,76 @@ bool get_value_by_key(const char* key, String& val) {
   }
 }
 
-void append_key_value(String& html, const char* key, const ulong value) {
-  html += "\"";
-  html += key;
-  html += "\":";
-  html += value;
-  html += ",";
-}
-
-void append_key_value(String& html, const char* key, const int16_t value) {
-  html += "\"";
-  html += key;
-  html += "\":";
-  html += value;
-  html += ",";
-}
-
-void append_key_value(String& html, const char* key, const String& value) {
-  html += "\"";
-  html += key;
-  html += "\":\"";
-  html += value;
-  html += "\",";
-}
-
 char dec2hexchar(byte dec) {
   if(dec<10) return '0'+dec;
   else return 'A'+(dec-10);
 }
 
-String get_mac() {
-  static String hex;
-  if(!hex.length()) {
-    byte mac[6];
-    WiFi.macAddress(mac);
+#define AP_SSID_SIZE 10  // OS_ followed by the last 3 bytes of the MAC address in hex
 
-    for(byte i=0;i<6;i++) {
-      hex += dec2hexchar((mac[i]>>4)&0x0F);
-      hex += dec2hexchar(mac[i]&0x0F);
-    }
+/** Name of the controller's access point */
+void get_ap_ssid(char *ap_ssid) {
+  byte mac[6];
+  WiFi.macAddress(mac);
+  *ap_ssid++ = 'O';
+  *ap_ssid++ = 'S';
+  *ap_ssid++ = '_';
+  for(byte i=3;i<6;i++) {
+    *ap_ssid++ = dec2hexchar((mac[i]>>4)&0x0F);
+    *ap_ssid++ = dec2hexchar(mac[i]&0x0F);
   }
-  return hex;
+  *ap_ssid = 0;
 }
 
-String get_ap_ssid() {
-  static String ap_ssid;
-  if(!ap_ssid.length()) {
-    byte mac[6];
-    WiFi.macAddress(mac);
-    ap_ssid += "OS_";
-    for(byte i=3;i<6;i++) {
-      ap_ssid += dec2hexchar((mac[i]>>4)&0x0F);
-      ap_ssid += dec2hexchar(mac[i]&0x0F);
-    }
+/** Networks seen in AP mode
+ * Scans run in the background (server_scan_loop) and are repeated every
+ * SCAN_INTERVAL, so /jsap lists current networks and the AP comes up
+ * without waiting for a scan. Scanning stops once a network has been
+ * chosen, as it would get in the way of joining it.
+ */
+#define SCAN_INTERVAL  60000L  // ms between background scans
+
+static ScanResult scan_results[MAX_SCAN_RESULTS];
+static byte scan_count = 0;
+static bool scan_running = false;
+static bool scan_stopped = false;
+static ulong scan_next = 0;        // millis() when the next scan is due
+
+void server_scan_loop() {
+  if(os.get_wifi_mode()!=WIFI_MODE_AP || os.state!=OS_STATE_CONNECTED) return;
+  if(scan_running) {
+    int n = scan_network_done(scan_results, MAX_SCAN_RESULTS);
+    if(n<0) return;
+    scan_count = n;
+    scan_running = false;
+    scan_next = millis()+SCAN_INTERVAL;
+  } else if(!scan_stopped && (long)(millis()-scan_next)>=0) {
+    scan_network_start();
+    scan_running = true;
   }
-  return ap_ssid;
 }
 
-static String scanned_ssids;
-
 void on_ap_home() {
   if(os.get_wifi_mode()!=WIFI_MODE_AP) return;
-  server_send_html(FPSTR(ap_home_html));
+  server_send_gz(ap_home_html_gz, sizeof(ap_home_html_gz));
 }
 
 void on_ap_scan() {
   if(os.get_wifi_mode()!=WIFI_MODE_AP) return;
-  server_send_html(scanned_ssids);
+  rewind_ether_buffer();
+  // keep the old format of the network list for mobile app compat
+  bfill.emit_p(PSTR("{\"ssids\":["));
+  for(byte i=0;i<scan_count;i++) {
+    if(i) bfill.emit_p(PSTR(",\r\n"));
+    bfill.emit_p(PSTR("\"$J\""), scan_results[i].ssid);
+  }
+  bfill.emit_p(PSTR("],\"rssis\":["));
+  for(byte i=0;i<scan_count;i++) {
+    if(i) bfill.emit_p(PSTR(",\r\n"));
+    bfill.emit_p(PSTR("\"$D\""), scan_results[i].rssi);
+  }
+  bfill.emit_p(PSTR("]}"));
+  send_ether_buffer();
 }
 
 void on_ap_change_config() {
@@ -374,6 +686,7 @@ void on_ap_change_config() {
     os.wifi_config.pass = wifi_server->arg("pass");
     os.options_save(true);
     server_send_result(HTML_SUCCESS);
+    scan_stopped = true;
     os.state = OS_STATE_TRY_CONNECT;
     //os.lcd.setCursor(0, 2);
     //os.lcd.print(F("Connecting..."));
@@ -384,12 +697,10 @@ void on_ap_change_config() {
 
 void on_ap_try_connect() {
   if(os.get_wifi_mode()!=WIFI_MODE_AP) return;
-  String html = "{";
   ulong ip = (WiFi.status()==WL_CONNECTED)?(uint32_t)WiFi.localIP():0;
-  append_key_value(html, "ip", ip);
-  html.remove(html.length()-1);  
-  html += "}";
-  server_send_html(html);
+  rewind_ether_buffer();
+  bfill.emit_p(PSTR("{\"ip\":$L}"), ip);
+  send_ether_buffer();
   if(WiFi.status() == WL_CONNECTED && WiFi.localIP()) {
     // IP received by client, restart
     os.reboot_dev();
@@ -398,20 +709,69 @@ void on_ap_try_connect() {
 
 
 /** Check and verify password */
+/** Session tokens
+ * /tk trades the password for a random token that authenticates later
+ * requests (tkn=xxx in place of pw=xxx) until it expires, so that polls
+ * are checked against a small RAM table. Tokens are dropped when the
+ * password changes.
+ */
+#define SESSION_MAX_TOKENS  4
+#define SESSION_TOKEN_SIZE  16        // random bytes per token, sent as hex digits
+#define SESSION_TTL         86400L    // token lifetime in seconds
+
+struct SessionToken {
+  byte token[SESSION_TOKEN_SIZE];
+  ulong expires;  // expiry time (millis)
+  bool used;
+};
+
+static SessionToken session_tokens[SESSION_MAX_TOKENS];
+
+static bool session_expired(const SessionToken *t) {
+  return !t->used || (long)(millis()-t->expires)>=0;
+}
+
+void session_clear() {
+  memset(session_tokens, 0, sizeof(session_tokens));
+}
+
+/** Check a token given as hex digits
+ * Every token in the table is compared in full, in constant time
+ */
+static bool session_verify(const char *hex) {
+  byte token[SESSION_TOKEN_SIZE];
+  if(strlen(hex)!=2*SESSION_TOKEN_SIZE) return false;
+  for(byte i=0;i<SESSION_TOKEN_SIZE;i++) {
+    token[i] = (h2int(hex[2*i])<<4) | h2int(hex[2*i+1]);
+  }
+  bool valid = false;
+  for(byte t=0;t<SESSION_MAX_TOKENS;t++) {
+    SessionToken *s = session_tokens+t;
+    byte diff = 0;
+    for(byte i=0;i<SESSION_TOKEN_SIZE;i++)  diff |= s->token[i]^token[i];
+    valid |= (diff==0) && !session_expired(s);
+  }
+  return valid;
+}
+
 boolean process_password(boolean fwv_on_fail=false, char *p = NULL)
 {
   if (os.options[OPTION_IGNORE_PASSWORD])  return true;
-  if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("pw"), true)) {
+  if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("tkn"), true)) {
+    if (session_verify(tmp_buffer))
+      return true;
+  } else if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("pw"), true)) {
     urlDecode(tmp_buffer);
     if (os.password_verify(tmp_buffer))
       return true;
   }
   /* some pages will output fwv if password check has failed */
+  METRICS_ERROR();
   if(fwv_on_fail) {
     rewind_ether_buffer();
     print_json_header();
     bfill.emit_p(PSTR("\"$F\":$D}"), op_json_names+0, os.options[0]);
-    server_send_html(ether_buffer);
+    send_ether_buffer();
   } else {
     server_send_result(HTML_UNAUTHORIZED);
   }
@@ -449,12 +809,9 @@ void server_json_stations_main()
   byte sid;
   for(sid=0;sid<os.nstations;sid++) {
     os.get_station_name(sid, tmp_buffer);
-    bfill.emit_p(PSTR("\"$S\""), tmp_buffer);
+    bfill.emit_p(PSTR("\"$J\""), tmp_buffer);
     if(sid!=os.nstations-1)
       bfill.emit_p(PSTR(","));
-    if (available_ether_buffer()<80) {
-      send_packet();
-    }
   }
   bfill.emit_p(PSTR("],\"maxlen\":$D}"), STATION_NAME_SIZE);
   INSERT_DELAY(1);
@@ -462,10 +819,10 @@ void server_json_stations_main()
 
 /** Output stations data */
 void server_json_stations() {
-  if(!process_password()) return;
+  if(server_not_modified(json_section_gen(JSON_SECTION_STATIONS), json_section_extra(JSON_SECTION_STATIONS))) return;
   rewind_ether_buffer();
   print_json_header();
-  server_json_stations_main();
+  server_json_section(JSON_SECTION_STATIONS);
   handle_return(HTML_OK);
 }
 
@@ -474,7 +831,6 @@ void server_json_station_special() {
   // if no sd card, return false
   if (!os.status.has_sd)  handle_return(HTML_PAGE_NOT_FOUND);
 
-  if(!process_password()) return;
   rewind_ether_buffer();
 
   byte sid;
@@ -487,7 +843,7 @@ void server_json_station_special() {
       read_from_file(stns_filename, (char*)stn, stepsize, sid*stepsize);
       if (comma) bfill.emit_p(PSTR(","));
       else {comma=1;}
-      bfill.emit_p(PSTR("\"$D\":{\"st\":$D,\"sd\":\"$S\"}"), sid, stn->type, stn->data);
+      bfill.emit_p(PSTR("\"$D\":{\"st\":$D,\"sd\":\"$J\"}"), sid, stn->type, stn->data);
     }
   }
   bfill.emit_p(PSTR("}"));
@@ -508,7 +864,7 @@ void server_change_stations_attrib(char *p, char header, int addr)
       attrib[bid] = atoi(tmp_buffer);
     }
   }
-  os.station_attrib_bits_save(addr, attrib);
+  if(!server_dry_run) os.station_attrib_bits_save(addr, attrib);
 }
 
 /**
@@ -526,7 +882,6 @@ void server_change_stations_attrib(char *p, char header, int addr)
  */
 void server_change_stations() {
   char* p = NULL;
-  if(!process_password()) return;
   byte sid;
   char tbuf2[4] = {'s', 0, 0, 0};
   // process station names
@@ -534,7 +889,7 @@ void server_change_stations() {
     itoa(sid, tbuf2+1, 10);
     if(findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, tbuf2)) {
       urlDecode(tmp_buffer);
-      os.set_station_name(sid, tmp_buffer);
+      if(!server_dry_run) os.set_station_name(sid, tmp_buffer);
     }
   }
 
@@ -546,6 +901,7 @@ void server_change_stations() {
   // only parse station special bits if it's supported
   if(os.status.has_sd) {
     server_change_stations_attrib(p, 'p', ADDR_NVM_STNSPE); // special
+    if(!server_dry_run) os.station_special_load();
   }
 
   /* handle special data */
@@ -560,24 +916,29 @@ void server_change_stations() {
 
       // only process GPIO and HTTP stations for OS 2.3, above, and OSPi
 	    if(tmp_buffer[0] == STN_TYPE_GPIO) {
-        // check that pin does not clash with OSPi pins
-		    byte gpio = (tmp_buffer[1] - '0') * 10 + tmp_buffer[2] - '0';
-		    byte activeState = tmp_buffer[3] - '0';
-
-		    byte gpioList[] = PIN_FREE_LIST;
-		    
-        bool found = false;
-		    for (int i = 0; i < sizeof(gpioList) && found == false; i++) {
-			  //  if (gpioList[i] == gpio) found = true;
-		    }
-		    if (!found || activeState > 1) handle_return(HTML_DATA_OUTOFBOUND);
+        // check that pin does not clash with pins in use by the controller or by another station
+        byte gpio, activeState;
+        if (!os.parse_gpiostation((GPIOStationData *)(tmp_buffer+1), &gpio, &activeState) ||
+            os.relay_pin_in_use(gpio, sid))
+          handle_return(HTML_DATA_OUTOFBOUND);
+        if (server_dry_run) {
+          if (dry_gpio_pins&(1UL<<gpio)) handle_return(HTML_DATA_OUTOFBOUND);
+          dry_gpio_pins |= (1UL<<gpio);
+        }
+	    } else if (tmp_buffer[0] == STN_TYPE_RF) {
+        // codes and pulse length must be valid (the pulse length bounded by the timer)
+        if (!os.parse_rfstation_code((RFStationData *)(tmp_buffer+1), NULL, NULL))
+          handle_return(HTML_DATA_OUTOFBOUND);
 	    } else if (tmp_buffer[0] == STN_TYPE_HTTP) {
 		    if (strlen(tmp_buffer+1) > sizeof(HTTPStationData)) {
 			    handle_return(HTML_DATA_OUTOFBOUND);
 		    }
 	    }
 
+      if(server_dry_run) handle_return(HTML_SUCCESS);
       write_to_file(stns_filename, tmp_buffer, strlen(tmp_buffer)+1, stepsize*sid, false);
+      os.data_changed(DATA_GEN_STATIONS);
+      os.station_special_load();
 
     } else {
 
@@ -615,7 +976,6 @@ void manual_start_program(byte, byte);
  */
 void server_manual_program() {
   char* p = NULL;
-  if(!process_password()) return;
 
   if (!findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("pid"), true))
     handle_return(HTML_DATA_MISSING);
@@ -647,7 +1007,6 @@ void server_manual_program() {
  */
 void server_change_runonce() {
   char* p = NULL;
-  if(!process_password()) return;
   if(!findKeyVal(p,tmp_buffer,TMP_BUFFER_SIZE, "t",false)) handle_return(HTML_DATA_MISSING);
   char *pv = tmp_buffer+1;
   // reset all stations and prepare to run one-time program
@@ -691,7 +1050,6 @@ void server_change_runonce() {
  */
 void server_delete_program() {
   char* p = NULL;
-  if(!process_password()) return;
   if (!findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("pid"), true))
     handle_return(HTML_DATA_MISSING);
 
@@ -716,7 +1074,6 @@ void server_delete_program() {
 */
 void server_moveup_program() {
   char* p = NULL;
-  if(!process_password()) return;
 
   if (!findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("pid"), true))
     handle_return(HTML_DATA_MISSING);
@@ -745,7 +1102,6 @@ const char _str_program[] PROGMEM = "Program ";
 void server_change_program() {
 
   char* p = NULL;
-  if(!process_password()) return;
   byte i;
 
   ProgramStruct prog;
@@ -759,6 +1115,7 @@ void server_change_program() {
   // check if "en" parameter is present
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("en"), true)) {
     if(pid<0) handle_return(HTML_DATA_OUTOFBOUND);
+    if(server_dry_run) handle_return(HTML_SUCCESS);
     pd.set_flagbit(pid, PROGRAMSTRUCT_EN_BIT, (tmp_buffer[0]=='0')?0:1);
     handle_return(HTML_SUCCESS);
   }
@@ -766,6 +1123,7 @@ void server_change_program() {
   // check if "uwt" parameter is present
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("uwt"), true)) {
     if(pid<0) handle_return(HTML_DATA_OUTOFBOUND);
+    if(server_dry_run) handle_return(HTML_SUCCESS);
     pd.set_flagbit(pid, PROGRAMSTRUCT_UWT_BIT, (tmp_buffer[0]=='0')?0:1);
     handle_return(HTML_SUCCESS);
   }
@@ -814,6 +1172,13 @@ void server_change_program() {
     pd.drem_to_absolute(prog.days);
   }
 
+  if (server_dry_run) {
+    if (pid==-1) {
+      if (dry_nprograms>=MAX_NUMBER_PROGRAMS) handle_return(HTML_DATA_OUTOFBOUND);
+      dry_nprograms++;
+    }
+    handle_return(HTML_SUCCESS);
+  }
   if (pid==-1) {
     if(!pd.add(&prog)) handle_return(HTML_DATA_OUTOFBOUND);
   } else {
@@ -854,10 +1219,10 @@ void server_json_options_main() {
 
 /** Output Options */
 void server_json_options() {
-  if(!process_password(true)) return;
+  if(server_not_modified(json_section_gen(JSON_SECTION_OPTIONS), json_section_extra(JSON_SECTION_OPTIONS))) return;
   rewind_ether_buffer();
   print_json_header();
-  server_json_options_main();
+  server_json_section(JSON_SECTION_OPTIONS);
   handle_return(HTML_OK);
 }
 
@@ -888,17 +1253,12 @@ void server_json_programs_main() {
     // program name
     strncpy(tmp_buffer, prog.name, PROGRAM_NAME_SIZE);
     tmp_buffer[PROGRAM_NAME_SIZE] = 0;  // make sure the string ends
-    bfill.emit_p(PSTR("$S"), tmp_buffer);
+    bfill.emit_p(PSTR("$J"), tmp_buffer);
     if(pid!=pd.nprograms-1) {
       bfill.emit_p(PSTR("\"],"));
     } else {
       bfill.emit_p(PSTR("\"]"));
     }
-    // push out a packet if available
-    // buffer size is getting small
-    if (available_ether_buffer() < 250) {
-      send_packet();
-    }
   }
   bfill.emit_p(PSTR("]}"));
   INSERT_DELAY(1);
@@ -906,11 +1266,17 @@ void server_json_programs_main() {
 
 /** Output program data */
 void server_json_programs() {
-  if(!process_password()) return;
+  server_accepts_cbor();
+  if(server_not_modified(json_section_gen(JSON_SECTION_PROGRAMS), json_section_extra(JSON_SECTION_PROGRAMS))) return;
   rewind_ether_buffer();
 
   print_json_header();
-  server_json_programs_main();
+  if(ether_cbor) {
+    CBORWriter w(bfill);
+    server_cbor_programs_main(w);
+  } else {
+    server_json_section(JSON_SECTION_PROGRAMS);
+  }
   handle_return(HTML_OK);
 }
 
@@ -929,7 +1295,7 @@ void server_json_controller_main() {
   ulong curr_time = os.now_tz();
   //os.nvm_string_get(ADDR_NVM_LOCATION, tmp_buffer);
   bfill.emit_p(PSTR("\"devt\":$L,\"nbrd\":$D,\"en\":$D,\"rd\":$D,\"rs\":$D,\"rdst\":$L,"
-                    "\"loc\":\"$E\",\"wtkey\":\"$E\",\"sunrise\":$D,\"sunset\":$D,\"eip\":$L,\"lwc\":$L,\"lswc\":$L,"
+                    "\"loc\":\"$N\",\"wtkey\":\"$N\",\"sunrise\":$D,\"sunset\":$D,\"eip\":$L,\"lwc\":$L,\"lswc\":$L,"
                     "\"lupt\":$L,\"lrun\":[$D,$D,$D,$L],"),
               curr_time,
               os.nboards,
@@ -970,12 +1336,6 @@ void server_json_controller_main() {
     }
     bfill.emit_p(PSTR("[$D,$L,$L]"), (qid<255)?q->pid:0, rem, (qid<255)?q->st:0);
     bfill.emit_p((sid<os.nstations-1)?PSTR(","):PSTR("]"));
-
-    // if available ether buffer is getting small
-    // send out a packet
-    if(available_ether_buffer() < 80) {
-      send_packet();
-    }
   }
 
   if(read_from_file(wtopts_filename, tmp_buffer)) {
@@ -983,7 +1343,7 @@ void server_json_controller_main() {
   }
   
   if(read_from_file(ifkey_filename, tmp_buffer)) {
-    bfill.emit_p(PSTR(",\"ifkey\":\"$S\""), tmp_buffer);
+    bfill.emit_p(PSTR(",\"ifkey\":\"$J\""), tmp_buffer);
   }
 
   bfill.emit_p(PSTR(",\"RSSI\":$D"), (int16_t)WiFi.RSSI());
@@ -993,7 +1353,6 @@ void server_json_controller_main() {
 
 /** Output controller variables in json */
 void server_json_controller() {
-  if(!process_password()) return;
   rewind_ether_buffer();
 
   print_json_header();
@@ -1001,6 +1360,336 @@ void server_json_controller() {
   handle_return(HTML_OK);
 }
 
+/** Delta status
+ * Status fields and station entries are tagged with the generation in which
+ * they last changed, so /jd can return only what changed since a client's cursor.
+ * Changes are detected when /jd is called, by comparing with the values seen
+ * by the previous call, so nothing is tracked while nobody polls.
+ */
+enum {
+  DELTA_EN = 0,
+  DELTA_RD,
+  DELTA_RS,
+  DELTA_RDST,
+  DELTA_SUNRISE,
+  DELTA_SUNSET,
+  DELTA_EIP,
+  DELTA_LWC,
+  DELTA_LSWC,
+  DELTA_LUPT,
+  DELTA_FLCRT,
+  DELTA_LRUN,
+  DELTA_SBITS,
+  NUM_DELTA_FIELDS
+};
+
+// each json name takes 8 characters
+static const char delta_json_names[] PROGMEM =
+  "en\0\0\0\0\0\0"
+  "rd\0\0\0\0\0\0"
+  "rs\0\0\0\0\0\0"
+  "rdst\0\0\0\0"
+  "sunrise\0"
+  "sunset\0\0"
+  "eip\0\0\0\0\0"
+  "lwc\0\0\0\0\0"
+  "lswc\0\0\0\0"
+  "lupt\0\0\0\0"
+  "flcrt\0\0\0"
+  "lrun\0\0\0\0"
+  "sbits\0\0\0";
+
+struct DeltaStation {
+  ulong st;     // scheduled start time
+  ulong dur;    // scheduled duration
+  byte pid;     // program index (0: not scheduled)
+  byte on;      // station bit
+  ulong gen;    // generation of the last change
+};
+
+static ulong delta_gen = 0;
+static ulong delta_values[NUM_DELTA_FIELDS];
+static ulong delta_field_gens[NUM_DELTA_FIELDS];
+static DeltaStation delta_stations[MAX_NUM_STATIONS];
+static byte delta_sbits[MAX_EXT_BOARDS+1];  // station bits as of the last update
+static LogStruct delta_lastrun;             // last run as of the last update
+static ulong delta_changes[2];              // number of changes of the station bits and the last run
+
+/** Current value of a delta status field
+ * The station bits and the last run do not fit a value, so they are compared
+ * with their copies from the last call, and their number of changes is returned
+ */
+static ulong delta_value(byte f) {
+  switch(f) {
+  case DELTA_EN:      return os.status.enabled;
+  case DELTA_RD:      return os.status.rain_delayed;
+  case DELTA_RS:      return os.status.rain_sensed;
+  case DELTA_RDST:    return os.nvdata.rd_stop_time;
+  case DELTA_SUNRISE: return os.nvdata.sunrise_time;
+  case DELTA_SUNSET:  return os.nvdata.sunset_time;
+  case DELTA_EIP:     return os.nvdata.external_ip;
+  case DELTA_LWC:     return os.checkwt_lasttime;
+  case DELTA_LSWC:    return os.checkwt_success_lasttime;
+  case DELTA_LUPT:    return os.powerup_lasttime;
+  case DELTA_FLCRT:   return (os.options[OPTION_SENSOR2_TYPE]==SENSOR_TYPE_FLOW) ? os.flowcount_rt : 0;
+  case DELTA_LRUN:
+    if(memcmp(&delta_lastrun, &pd.lastrun, sizeof(LogStruct))) {
+      delta_lastrun = pd.lastrun;
+      delta_changes[0]++;
+    }
+    return delta_changes[0];
+  case DELTA_SBITS:
+    if(memcmp(delta_sbits, os.station_bits, sizeof(delta_sbits))) {
+      memcpy(delta_sbits, os.station_bits, sizeof(delta_sbits));
+      delta_changes[1]++;
+    }
+    return delta_changes[1];
+  }
+  return 0;
+}
+
+/** Tag the fields and stations that changed since the last call with a new generation */
+static void delta_update() {
+  ulong gen = delta_gen+1;
+  bool changed = false;
+  for(byte f=0;f<NUM_DELTA_FIELDS;f++) {
+    ulong v = delta_value(f);
+    if(v!=delta_values[f] || !delta_gen) {
+      delta_values[f] = v;
+      delta_field_gens[f] = gen;
+      changed = true;
+    }
+  }
+  for(byte sid=0;sid<os.nstations;sid++) {
+    DeltaStation d = {0, 0, 0, 0, 0};
+    byte qid = pd.station_qid[sid];
+    if(qid<255) {
+      RuntimeQueueStruct *q = pd.queue + qid;
+      d.st = q->st;
+      d.dur = q->dur;
+      d.pid = q->pid;
+    }
+    d.on = (os.station_bits[sid>>3]>>(sid&0x07))&1;
+    DeltaStation *o = delta_stations+sid;
+    if(d.st!=o->st || d.dur!=o->dur || d.pid!=o->pid || d.on!=o->on || !delta_gen) {
+      d.gen = gen;
+      *o = d;
+      changed = true;
+    }
+  }
+  if(changed) delta_gen = gen;
+}
+
+/**
+ * Output status changes
+ * Command: /jd?pw=xxx&since=xxx
+ *
+ * pw:    password
+ * since: generation returned by the previous call (0 or missing: output everything)
+ *
+ * Returns the new generation, the boot id (if it changes, the controller has
+ * rebooted and the client should start over with since=0), the device time,
+ * the status fields that changed, and the changed stations in "ps" as
+ * "sid":[pid,rem,st] (a station entry changes when it is scheduled, started,
+ * stopped or unscheduled, its remaining time is as of devt)
+ */
+void server_json_delta() {
+  char* p = NULL;
+  ulong since = 0;
+  if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("since"), true)) {
+    since = strtoul(tmp_buffer, NULL, 10);
+  }
+  delta_update();
+  bool full = (since==0 || since>delta_gen);
+  ulong curr_time = os.now_tz();
+
+  rewind_ether_buffer();
+  print_json_header();
+  bfill.emit_p(PSTR("\"gen\":$L,\"boot\":$L,\"full\":$D,\"devt\":$L"), delta_gen, os.boot_id, full, curr_time);
+  byte f;
+  for(f=0;f<NUM_DELTA_FIELDS;f++) {
+    if(!full && delta_field_gens[f]<=since) continue;
+    if(f==DELTA_FLCRT && os.options[OPTION_SENSOR2_TYPE]!=SENSOR_TYPE_FLOW) continue;
+    bfill.emit_p(PSTR(",\"$F\":"), delta_json_names+f*8);
+    if(f==DELTA_LRUN) {
+      bfill.emit_p(PSTR("[$D,$D,$D,$L]"), pd.lastrun.station, pd.lastrun.program, pd.lastrun.duration, pd.lastrun.endtime);
+    } else if(f==DELTA_SBITS) {
+      bfill.emit_p(PSTR("["));
+      for(byte bid=0;bid<os.nboards;bid++)
+        bfill.emit_p(PSTR("$D,"), os.station_bits[bid]);
+      bfill.emit_p(PSTR("0]"));
+    } else {
+      bfill.emit_p(PSTR("$L"), delta_values[f]);
+    }
+  }
+  bfill.emit_p(PSTR(",\"ps\":{"));
+  bool comma = 0;
+  for(byte sid=0;sid<os.nstations;sid++) {
+    DeltaStation *d = delta_stations+sid;
+    if(!full && d->gen<=since) continue;
+    unsigned long rem = 0;
+    if(d->pid) {
+      rem = (curr_time >= d->st) ? (d->st+d->dur-curr_time) : d->dur;
+      if(rem>65535) rem = 0;
+    }
+    if (comma) bfill.emit_p(PSTR(","));
+    else {comma=1;}
+    bfill.emit_p(PSTR("\"$D\":[$D,$L,$L]"), sid, d->pid, rem, d->st);
+  }
+  bfill.emit_p(PSTR("}}"));
+  handle_return(HTML_OK);
+}
+
+/** Event stream
+ * Clients subscribed to /ev are pushed server-sent events as they happen:
+ *   station:  a station bit changed (taken from the relay trace)
+ *   rain:     rain delay (rd) or rain sensor (rs) status flipped
+ *   program:  a program was scheduled
+ *   weather:  a weather call updated the water level, external ip or sun times
+ *   status:   current status, sent on subscribing, and whenever station
+ *             changes were missed because the relay trace wrapped around
+ * Events are queued by sse_post and written out by sse_loop from the main loop.
+ * Writing never waits: a subscriber whose socket cannot take a whole event is
+ * dropped (the browser reconnects by itself and gets a fresh status event).
+ */
+#define SSE_MAX_CLIENTS    2      // number of concurrent subscribers
+#define SSE_QUEUE_SIZE     8      // number of pending events (must be a power of 2)
+#define SSE_EVENT_SIZE     160    // maximum size of one event
+#define SSE_KEEPALIVE_MS   15000  // idle subscribers are sent a comment line this often
+
+struct SSEEvent {
+  byte type;    // IFTTT_* event type
+  ulong lval;
+  ulong ival;
+};
+
+static WiFiClient sse_clients[SSE_MAX_CLIENTS];
+static bool sse_active[SSE_MAX_CLIENTS];
+static byte sse_nclients = 0;
+static SSEEvent sse_queue[SSE_QUEUE_SIZE];
+static byte sse_qhead = 0, sse_qtail = 0;
+static ulong sse_trace_seq = 0;   // next relay trace record to push
+static ulong sse_last_write = 0;
+
+/** Queue an event for the subscribers
+ * type uses the IFTTT_* notification types, lval/ival as in push_message.
+ * If the queue is full, the oldest event is dropped.
+ */
+void sse_post(byte type, ulong lval, ulong ival) {
+  if(!sse_nclients) return;
+  SSEEvent *e = sse_queue + (sse_qtail & (SSE_QUEUE_SIZE-1));
+  e->type = type;
+  e->lval = lval;
+  e->ival = ival;
+  sse_qtail++;
+  if((byte)(sse_qtail-sse_qhead)>SSE_QUEUE_SIZE) sse_qhead++;
+}
+
+static void sse_emit_status(BufferFiller &f) {
+  f.emit_p(PSTR("event: status\ndata: {\"devt\":$L,\"rd\":$D,\"rs\":$D,\"sbits\":["),
+           os.now_tz(), os.status.rain_delayed, os.status.rain_sensed);
+  for(byte bid=0;bid<os.nboards;bid++)
+    f.emit_p(PSTR("$D,"), os.station_bits[bid]);
+  f.emit_p(PSTR("0]}\n\n"));
+}
+
+/** Write an event to all subscribers, dropping those that cannot take it now */
+static void sse_send(const char *data, unsigned int len) {
+  for(byte i=0;i<SSE_MAX_CLIENTS;i++) {
+    WiFiClient &c = sse_clients[i];
+    if(!sse_active[i]) continue;
+    if(!c.connected() || c.availableForWrite()<len || c.write((const uint8_t*)data, len)!=len) {
+      DEBUG_PRINTLN(F("sse: dropped subscriber"));
+      c.stop();
+      c = WiFiClient();
+      sse_active[i] = false;
+      sse_nclients--;
+    }
+  }
+  sse_last_write = millis();
+}
+
+/** Push pending events to the subscribers, called from the main loop */
+void sse_loop() {
+  ulong head = relaytrace_head();
+  if(!sse_nclients) {
+    sse_trace_seq = head;
+    sse_qhead = sse_qtail;
+    return;
+  }
+  char buf[SSE_EVENT_SIZE];
+  BufferFiller f(buf, sizeof(buf));
+  if(head-sse_trace_seq>RELAY_TRACE_SIZE) {
+    sse_emit_status(f);
+    sse_send(buf, f.position());
+    sse_trace_seq = head;
+  }
+  RelayTraceRecord rec;
+  for(;sse_trace_seq<head && sse_nclients;sse_trace_seq++) {
+    if(!relaytrace_get(sse_trace_seq, &rec)) continue;
+    f = BufferFiller(buf, sizeof(buf));
+    f.emit_p(PSTR("event: station\ndata: {\"sid\":$D,\"on\":$D,\"cause\":$D}\n\n"), rec.sid, rec.state, rec.cause);
+    sse_send(buf, f.position());
+  }
+  for(;sse_qhead!=sse_qtail && sse_nclients;sse_qhead++) {
+    SSEEvent *e = sse_queue + (sse_qhead & (SSE_QUEUE_SIZE-1));
+    f = BufferFiller(buf, sizeof(buf));
+    switch(e->type) {
+    case IFTTT_RAINSENSOR:
+      f.emit_p(PSTR("event: rain\ndata: {\"$F\":$D}\n\n"),
+               (e->lval==LOGDATA_RAINDELAY) ? PSTR("rd") : PSTR("rs"), (int)e->ival);
+      break;
+    case IFTTT_PROGRAM_SCHED:
+      f.emit_p(PSTR("event: program\ndata: {\"pid\":$D,\"wl\":$D}\n\n"), (int)e->lval, (int)e->ival);
+      break;
+    case IFTTT_WEATHER_UPDATE:
+      f.emit_p(PSTR("event: weather\ndata: {\"wl\":$D,\"eip\":$L,\"sunrise\":$D,\"sunset\":$D}\n\n"),
+               os.options[OPTION_WATER_PERCENTAGE], os.nvdata.external_ip,
+               os.nvdata.sunrise_time, os.nvdata.sunset_time);
+      break;
+    default:
+      continue;
+    }
+    sse_send(buf, f.position());
+  }
+  if(sse_nclients && millis()-sse_last_write>=SSE_KEEPALIVE_MS) {
+    sse_send(":\n\n", 3);
+  }
+}
+
+/**
+ * Subscribe to the event stream
+ * Command: /ev?pw=xxx
+ *
+ * pw: password
+ * The response is a text/event-stream that stays open, see sse_loop
+ */
+void server_event_stream() {
+  byte i;
+  for(i=0;i<SSE_MAX_CLIENTS;i++) {
+    if(!sse_active[i]) break;
+  }
+  if(i==SSE_MAX_CLIENTS) handle_return(HTML_NOT_PERMITTED);
+
+  // the response is written to the socket directly and the web server
+  // sends nothing itself, so the connection outlives the request
+  WiFiClient &c = sse_clients[i];
+  c = wifi_server->client();
+  c.setNoDelay(true);
+  char buf[SSE_EVENT_SIZE+96];
+  BufferFiller f(buf, sizeof(buf));
+  f.emit_p(PSTR("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                "Access-Control-Allow-Origin: *\r\nConnection: keep-alive\r\n\r\nretry: 2000\n\n"));
+  sse_emit_status(f);
+  if(!sse_nclients) {
+    sse_trace_seq = relaytrace_head();
+    sse_qhead = sse_qtail;
+  }
+  sse_active[i] = true;
+  sse_nclients++;
+  sse_send(buf, f.position());
+}
+
 /** Output homepage */
 void server_home()
 {
@@ -1035,7 +1724,6 @@ void server_change_values()
 {
   char* p = NULL;
   extern unsigned long reboot_timer;
-  if(!process_password()) return;
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("rsn"), true)) {
     reset_all_stations();
   }
@@ -1097,7 +1785,6 @@ void string_remove_space(char *src) {
  */
 void server_change_scripturl() {
   char* p = NULL;
-  if(!process_password()) return;
   
 #if defined(DEMO)
   handle_return(HTML_REDIRECT_HOME);
@@ -1131,7 +1818,6 @@ void server_change_scripturl() {
 void server_change_options()
 {
   char* p = NULL;
-  if(!process_password()) return;
 
   // temporarily save some old options values
 	bool time_change = false;
@@ -1177,6 +1863,7 @@ void server_change_options()
 		    }
 		  }
     }
+    if (server_dry_run) continue;
     if (os.options[oid] != prev_value) {	// if value has changed
     	if (oid==OPTION_TIMEZONE || oid==OPTION_USE_NTP)    time_change = true;
     	if (oid>=OPTION_NTP_IP1 && oid<=OPTION_NTP_IP4)     time_change = true;
@@ -1186,6 +1873,16 @@ void server_change_options()
     }
   }
 
+  // the other fields are not checked, so a dry run ends here, with the board
+  // count set as options_save would for the commands after it
+  // (the caller restores the options and the board count)
+  if (server_dry_run) {
+    if (err) handle_return(HTML_DATA_OUTOFBOUND);
+    os.nboards = os.options[OPTION_EXT_BOARDS]+1;
+    os.nstations = os.nboards*8;
+    handle_return(HTML_SUCCESS);
+  }
+
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("loc"), true)) {
     urlDecode(tmp_buffer);
     tmp_buffer[MAX_LOCATION-1]=0;   // make sure we don't exceed the maximum size
@@ -1231,7 +1928,11 @@ void server_change_options()
     write_to_file(wtopts_filename, tmp_buffer, strlen(tmp_buffer));
     weather_change = true;
   }
-  if (err)  handle_return(HTML_DATA_OUTOFBOUND);
+  if (err) {
+    // the valid values are kept in RAM (though not saved), so they are what /jo shows
+    os.data_changed(DATA_GEN_OPTIONS);
+    handle_return(HTML_DATA_OUTOFBOUND);
+  }
 
   os.options_save();
 
@@ -1265,13 +1966,13 @@ void server_change_password() {
 #endif
 
   char* p = NULL;
-  if(!process_password()) return;
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("npw"), true)) {
     char tbuf2[TMP_BUFFER_SIZE];
     if (findKeyVal(p, tbuf2, TMP_BUFFER_SIZE, PSTR("cpw"), true) && strncmp(tmp_buffer, tbuf2, MAX_USER_PASSWORD) == 0) {
       urlDecode(tmp_buffer);
       tmp_buffer[MAX_USER_PASSWORD-1]=0;  // make sure we don't exceed the maximum size
-      nvm_write_block(tmp_buffer, (void*)ADDR_NVM_PASSWORD, strlen(tmp_buffer)+1);
+      os.password_set(tmp_buffer);
+      session_clear();
       handle_return(HTML_SUCCESS);
     } else {
       handle_return(HTML_MISMATCH);
@@ -1280,6 +1981,40 @@ void server_change_password() {
   handle_return(HTML_DATA_MISSING);
 }
 
+/**
+ * Create a session token
+ * Command: /tk?pw=xxx
+ *
+ * pw: password
+ * Returns the token and its lifetime in seconds. Requests can then
+ * pass tkn=<token> instead of pw. The slot of the oldest token is
+ * reused when the table is full.
+ */
+void server_session_token() {
+  SessionToken *s = session_tokens;
+  for(byte t=0;t<SESSION_MAX_TOKENS;t++) {
+    SessionToken *o = session_tokens+t;
+    if(session_expired(o)) { s = o; break; }
+    if((long)(o->expires-s->expires)<0) s = o;
+  }
+  for(byte i=0;i<SESSION_TOKEN_SIZE;i+=4) {
+    uint32_t r = RANDOM_REG32;  // hardware random number generator
+    memcpy(s->token+i, &r, 4);
+  }
+  s->expires = millis()+SESSION_TTL*1000L;
+  s->used = true;
+
+  rewind_ether_buffer();
+  print_json_header();
+  bfill.emit_p(PSTR("\"tkn\":\""));
+  for(byte i=0;i<SESSION_TOKEN_SIZE;i++) {
+    bfill.put("0123456789abcdef"[s->token[i]>>4]);
+    bfill.put("0123456789abcdef"[s->token[i]&0x0F]);
+  }
+  bfill.emit_p(PSTR("\",\"ttl\":$L}"), SESSION_TTL);
+  handle_return(HTML_OK);
+}
+
 void server_json_status_main() {
   bfill.emit_p(PSTR("\"sn\":["));
   byte sid;
@@ -1295,7 +2030,6 @@ void server_json_status_main() {
 /** Output station status */
 void server_json_status()
 {
-  if(!process_password()) return;
   rewind_ether_buffer();
   print_json_header();
   server_json_status_main();
@@ -1313,7 +2047,6 @@ void server_json_status()
  */
 void server_change_manual() {
   char* p = NULL;
-  if(!process_password()) return;
 
   int sid=-1;
   if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("sid"), true)) {
@@ -1345,6 +2078,15 @@ void server_change_manual() {
       byte s = sid&0x07;
       if ((os.status.mas==sid+1) || (os.status.mas2==sid+1))
         handle_return(HTML_NOT_PERMITTED);
+      if (server_dry_run) {
+        // a station without a schedule takes a new queue element
+        if (pd.station_qid[sid]==0xFF && !(dry_queued[bid]&(1<<s))) {
+          if (dry_nqueue>=RUNTIME_QUEUE_SIZE) handle_return(HTML_NOT_PERMITTED);
+          dry_nqueue++;
+          dry_queued[bid] |= (1<<s);
+        }
+        handle_return(HTML_SUCCESS);
+      }
 
       RuntimeQueueStruct *q = NULL;
       byte sqi = pd.station_qid[sid];
@@ -1368,22 +2110,423 @@ void server_change_manual() {
       handle_return(HTML_DATA_MISSING);
     }
   } else {  // turn off station
+    if (server_dry_run) handle_return(HTML_SUCCESS);
+    relaytrace_cause = RELAY_CAUSE_MANUAL;
     turn_off_station(sid, curr_time);
   }
   handle_return(HTML_SUCCESS);
 }
 
+/** Commands accepted by /cb */
+struct BatchCommand {
+  char key[3];
+  URLHandler handler;
+};
+
+static const BatchCommand batch_commands[] = {
+  {"cp", server_change_program},
+  {"cs", server_change_stations},
+  {"co", server_change_options},
+  {"cm", server_change_manual}
+};
+#define BATCH_NUM_COMMANDS  (sizeof(batch_commands)/sizeof(batch_commands[0]))
+#define BATCH_MAX_LINES     64
+
+/** Run one /cb command line ("cp?pid=-1&v=...") and return its result code */
+static byte server_batch_run(char *line) {
+  char *q = strchr(line, '?');
+  if((q ? q-line : (int)strlen(line))!=2) return HTML_PAGE_NOT_FOUND;
+  const BatchCommand *c;
+  for(c=batch_commands;c<batch_commands+BATCH_NUM_COMMANDS;c++) {
+    if(c->key[0]==line[0] && c->key[1]==line[1]) break;
+  }
+  if(c==batch_commands+BATCH_NUM_COMMANDS) return HTML_PAGE_NOT_FOUND;
+  query_batch = q ? q+1 : line+2;
+  return_code = HTML_SUCCESS;
+  c->handler();
+  query_batch = NULL;
+  return return_code;
+}
+
+/**
+ * Run a batch of commands
+ * Command: POST /cb?pw=xxx
+ *
+ * pw:   password
+ * body: one command per line, written as the command's url without the
+ *       password: cp?..., cs?..., co?... or cm?... (program changes,
+ *       station names and attributes, options and manual station runs),
+ *       sent as text/plain (the body of a form-encoded POST is parsed into
+ *       arguments by the core and never reaches the handler)
+ * All commands are checked first, each against the state the commands
+ * before it leave: the options and board count, the program count and
+ * queue space, and the GPIO station pins taken (turning stations off or
+ * changing their type is not counted as freeing anything). If any of them
+ * fails, nothing is applied. Otherwise they are applied in order, with the
+ * NVM file written in one go. Applying is not undone: should a command
+ * still fail then (the flash being full, say), the ones before it stay applied.
+ * Program indices refer to the programs as they are before the batch.
+ * Returns the overall result and the result code of each command.
+ */
+void server_batch() {
+  String body = wifi_server->arg("plain");
+  if(!body.length())  handle_return(HTML_DATA_MISSING);
+  // the commands are split in place in ether_buffer; the response is
+  // written there only after the last command has run
+  if(body.length()>=ETHER_BUFFER_SIZE)  handle_return(HTML_DATA_OUTOFBOUND);
+  strcpy(ether_buffer, body.c_str());
+  body = String();
+
+  char *lines[BATCH_MAX_LINES];
+  byte results[BATCH_MAX_LINES];
+  byte n=0;
+  for(char *l=strtok(ether_buffer, "\r\n");l;l=strtok(NULL, "\r\n")) {
+    if(n==BATCH_MAX_LINES)  handle_return(HTML_DATA_OUTOFBOUND);
+    lines[n++] = l;
+  }
+
+  // check all commands; /co changes the options (and board count) in RAM,
+  // so later commands are checked against them, and they are restored after
+  byte options[NUM_OPTIONS];
+  byte nboards = os.nboards, nstations = os.nstations;
+  memcpy(options, os.options, NUM_OPTIONS);
+  byte result = HTML_SUCCESS;
+  server_dry_run = true;
+  dry_nprograms = pd.nprograms;
+  dry_nqueue = pd.nqueue;
+  memset(dry_queued, 0, sizeof(dry_queued));
+  dry_gpio_pins = 0;
+  for(byte i=0;i<n;i++) {
+    results[i] = server_batch_run(lines[i]);
+    if(results[i]!=HTML_SUCCESS && result==HTML_SUCCESS)  result = results[i];
+  }
+  server_dry_run = false;
+  memcpy(os.options, options, NUM_OPTIONS);
+  os.nboards = nboards;
+  os.nstations = nstations;
+
+  if(result==HTML_SUCCESS) {
+    nvm_begin();
+    for(byte i=0;i<n;i++) {
+      results[i] = server_batch_run(lines[i]);
+      if(results[i]!=HTML_SUCCESS && result==HTML_SUCCESS)  result = results[i];
+    }
+    nvm_commit();
+  }
+
+  rewind_ether_buffer();
+  print_json_header();
+  bfill.emit_p(PSTR("\"result\":$D,\"results\":["), result);
+  for(byte i=0;i<n;i++) {
+    bfill.emit_p(i ? PSTR(",$D") : PSTR("$D"), results[i]);
+  }
+  bfill.emit_p(PSTR("]}"));
+  handle_return(HTML_OK);
+}
+
+
+/** Admission control
+ * Keeps clients from crowding out the scheduler:
+ * - each client ip has a token bucket: a request takes one token (an
+ *   expensive one RATE_HEAVY_COST), and tokens come back at RATE_PER_SEC
+ * - the time spent on HTTP work is counted per one-second window: new
+ *   requests are refused once HTTP_BUDGET_MS is used up, expensive ones
+ *   (and the slices of response jobs) already at HTTP_BUDGET_HEAVY_MS
+ * Refused requests get 429 with Retry-After.
+ */
+#define RATE_MAX_CLIENTS      8     // number of client ips tracked
+#define RATE_BURST            20    // tokens a client can save up
+#define RATE_PER_SEC          5     // tokens returned per second
+#define RATE_HEAVY_COST       5     // tokens taken by an expensive request
+#define HTTP_BUDGET_MS        300   // HTTP work allowed per second
+#define HTTP_BUDGET_HEAVY_MS  100   // HTTP work after which expensive work is held back
+
+struct RateBucket {
+  uint32_t ip;
+  ulong tokens;     // in 1/1000 tokens
+  ulong last;       // time (millis) of the last refill
+};
+
+static RateBucket rate_buckets[RATE_MAX_CLIENTS];
+static ulong http_budget_start = 0;   // start (millis) of the current window
+static ulong http_budget_used = 0;    // HTTP work in the current window (us)
+
+/** HTTP work time left in the current window, under the given limit (ms) */
+static bool http_budget_left(ulong limit_ms) {
+  if(millis()-http_budget_start>=1000) {
+    http_budget_start = millis();
+    http_budget_used = 0;
+  }
+  return http_budget_used < limit_ms*1000L;
+}
+
+/** Count HTTP work that started at t0 (micros) */
+static void http_budget_charge(ulong t0) {
+  http_budget_used += micros()-t0;
+}
+
+/** Take tokens from a client's bucket, returns false if it does not have enough */
+static bool rate_take(uint32_t ip, byte cost) {
+  RateBucket *b, *lru = rate_buckets;
+  ulong curr = millis();
+  for(b=rate_buckets;b<rate_buckets+RATE_MAX_CLIENTS;b++) {
+    if(b->ip==ip) break;
+    if((long)(b->last-lru->last)<0) lru = b;
+  }
+  if(b==rate_buckets+RATE_MAX_CLIENTS) {
+    // new client: take over the least recently seen slot with a full bucket
+    b = lru;
+    b->ip = ip;
+    b->tokens = RATE_BURST*1000L;
+  } else {
+    b->tokens += (curr-b->last)*RATE_PER_SEC;
+    if(b->tokens>RATE_BURST*1000L) b->tokens = RATE_BURST*1000L;
+  }
+  b->last = curr;
+  if(b->tokens<cost*1000L) return false;
+  b->tokens -= cost*1000L;
+  return true;
+}
+
+/** Decide whether to serve the current request */
+bool server_admit(bool heavy) {
+  if(!http_budget_left(heavy ? HTTP_BUDGET_HEAVY_MS : HTTP_BUDGET_MS)) return false;
+  return rate_take((uint32_t)wifi_server->client().remoteIP(), heavy ? RATE_HEAVY_COST : 1);
+}
+
+void server_send_throttled() {
+  METRICS_ERROR();
+  wifi_server->sendHeader("Retry-After", "1");
+  wifi_server->sendHeader("Access-Control-Allow-Origin", "*");
+  wifi_server->send(429, "application/json", "{}");
+}
+
+/** Response jobs
+ * A response that takes long to produce (/jl reads through up to a year of
+ * log files) is not generated to completion inside the request handler.
+ * The handler checks the request and hands the connection to a job, and the
+ * main loop then advances every job by one bounded slice per pass (sse_loop
+ * style): at most one job buffer is generated, and only as much of it is
+ * written as the socket takes without waiting. The scheduler keeps running
+ * and the web server keeps serving other clients while a slow client is
+ * downloading. The response ends when the connection is closed.
+ */
+#define SERVER_MAX_JOBS       2
+#define JOB_BUFFER_SIZE       1024
+#define JOB_TIMEOUT_MS        30000  // drop a job whose client takes nothing for this long
+#define LOG_READ_SIZE         512    // bytes read from a log file at a time
+#define LOG_RECORD_SLACK      8      // output room a record needs beyond its text (separator, CBOR heads)
+
+/** Position in the log files of a /jl request
+ * Log files are read a block at a time into rbuf, and records are
+ * filtered and output from there, without being copied into a line buffer.
+ */
+struct LogCursor {
+  unsigned int day;   // day of the open file
+  unsigned int end;   // last day to output
+  File file;
+  bool open;
+  bool type_specified;
+  char type[4];
+  char *line;         // record that did not fit into the last output buffer (NULL: none)
+  uint16_t line_len;
+  uint16_t rpos, rlen;  // unread part of rbuf
+  char rbuf[LOG_READ_SIZE+1];  // +1 for the 0 after a line that fills the buffer
+};
+
+struct ResponseJob;
+typedef bool (*JobStep)(ResponseJob *job, BufferFiller &out);  // returns false once the response is complete
+
+struct ResponseJob {
+  WiFiClient client;
+  JobStep step;       // NULL: slot is free
+  bool done;          // step has produced the end of the response
+  bool cbor;
+  bool comma;
+  uint16_t pos, len;  // unsent part of buf
+  ulong last_write;   // time (millis) of the last progress
+#if defined(ENABLE_SERVER_METRICS)
+  byte metric;        // metric of the request that started the job
+#endif
+  LogCursor log;
+  char buf[JOB_BUFFER_SIZE];
+};
+
+static ResponseJob server_jobs[SERVER_MAX_JOBS];
 
-int file_fgets(File file, char* buf, int maxsize) {
-  int index=0;
-  while(index<maxsize) {
-    int c = file.read();
-    if(c<0||c=='\n') break;
-    if(c=='\r') continue; // skip \r
-    *buf++ = (char)c;
-    index++;
+/** Start a job on the current request's connection
+ * The response header is queued as the first output. Returns NULL if all job slots are busy.
+ * The server is done with the request once the handler returns, so it cannot read another
+ * request from the connection: a job's response has no length and ends by closing it.
+ */
+static ResponseJob* server_job_start(JobStep step) {
+  ResponseJob *j;
+  for(j=server_jobs;j<server_jobs+SERVER_MAX_JOBS;j++) {
+    if(!j->step) break;
+  }
+  if(j==server_jobs+SERVER_MAX_JOBS) return NULL;
+  j->client = wifi_server->client();
+#if !(defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3))
+  // the 2.4 core holds on to its copy of the client until it is closed (HC_WAIT_CLOSE),
+  // which keeps handleClient() from taking new connections while the job runs
+  wifi_server->client().stop();
+#endif
+  j->step = step;
+  j->done = false;
+  j->cbor = ether_cbor;
+  j->comma = false;
+  j->last_write = millis();
+#if defined(ENABLE_SERVER_METRICS)
+  j->metric = metrics_current;
+#endif
+  BufferFiller f(j->buf, JOB_BUFFER_SIZE);
+  f.emit_p(PSTR("HTTP/1.1 200 OK\r\nContent-Type: $F\r\nCache-Control: max-age=0, no-cache, no-store, must-revalidate\r\n"
+                "Access-Control-Allow-Origin: *\r\nVary: Accept\r\nConnection: close\r\n\r\n"),
+           j->cbor ? PSTR("application/cbor") : PSTR("application/json"));
+  j->pos = 0;
+  j->len = f.position();
+  return j;
+}
+
+static void server_job_finish(ResponseJob *j) {
+  if(j->log.open) j->log.file.close();
+  j->log.open = false;
+  j->client.stop();
+  j->client = WiFiClient();
+  j->step = NULL;
+}
+
+/** Advance all jobs by one slice, called from the main loop */
+void server_job_loop() {
+  for(ResponseJob *j=server_jobs;j<server_jobs+SERVER_MAX_JOBS;j++) {
+    if(!j->step) continue;
+    if(!http_budget_left(HTTP_BUDGET_HEAVY_MS)) return;  // the jobs are continued once there is time
+    ulong t0 = micros();
+    if(!j->client.connected() || millis()-j->last_write>JOB_TIMEOUT_MS) {
+      server_job_finish(j);
+      continue;
+    }
+    if(j->pos==j->len) {
+      if(j->done) {
+        server_job_finish(j);
+        continue;
+      }
+      BufferFiller f(j->buf, JOB_BUFFER_SIZE);
+      j->done = !j->step(j, f);
+      j->pos = 0;
+      j->len = f.position();
+    }
+    size_t n = j->client.availableForWrite();
+    if(n>(size_t)(j->len-j->pos)) n = j->len-j->pos;
+    if(n) n = j->client.write((const uint8_t*)j->buf+j->pos, n);
+    if(n) {
+      j->pos += n;
+      j->last_write = millis();
+#if defined(ENABLE_SERVER_METRICS)
+      metrics_add_bytes(j->metric, n);
+#endif
+    }
+    http_budget_charge(t0);
   }
-  return index;
+}
+
+/** Read the next line of the open log file
+ * The line is terminated with 0 in place and stays valid until the next
+ * read. Returns NULL at the end of the file.
+ */
+static char* log_read_line(LogCursor *c, uint16_t *len) {
+  char *s = c->rbuf+c->rpos;
+  char *nl = (char*)memchr(s, '\n', c->rlen-c->rpos);
+  if(!nl) {
+    // move the partial line to the front and fill up the buffer
+    uint16_t n = c->rlen-c->rpos;
+    memmove(c->rbuf, s, n);
+    c->rpos = 0;
+    c->rlen = n+c->file.read((uint8_t*)c->rbuf+n, LOG_READ_SIZE-n);
+    s = c->rbuf;
+    if(!c->rlen) return NULL;
+    nl = (char*)memchr(s, '\n', c->rlen);
+    // the last line may have no line end, and a line that fills the buffer is cut
+    if(!nl) nl = s+c->rlen;
+  }
+  c->rpos = (nl-c->rbuf)+1;
+  if(c->rpos>c->rlen) c->rpos = c->rlen;
+  if(nl>s && nl[-1]=='\r') nl--;
+  *nl = 0;
+  *len = nl-s;
+  return s;
+}
+
+/** Find the next log record of a /jl request
+ * Returns the record (in the read buffer) and its length, or NULL when
+ * there are no more records
+ */
+static char* log_next_record(LogCursor *c, uint16_t *len) {
+  if(c->line) {
+    char *line = c->line;
+    *len = c->line_len;
+    c->line = NULL;
+    return line;
+  }
+  while(true) {
+    if(!c->open) {
+      if(c->day>c->end) return NULL;
+      itoa(c->day++, tmp_buffer, 10);
+      make_logfile_name(tmp_buffer);
+      c->file = SPIFFS.open(tmp_buffer, "r");
+      if(!c->file) continue;
+      c->open = true;
+      c->rpos = c->rlen = 0;
+    }
+    char *line = log_read_line(c, len);
+    if (!line) {
+      c->file.close();
+      c->open = false;
+      continue;
+    }
+    // check record type
+    // records are all in the form of [x,"xx",...]
+    // where x is program index (>0) if this is a station record
+    // and "xx" is the type name if this is a special record (e.g. wl, fl, rs)
+
+    // search string until we find the first comma
+    char *ptype = (char*)memchr(line, ',', *len);
+    if (!ptype) continue; // didn't find comma, move on
+    ptype++;  // move past comma
+
+    if (c->type_specified && strncmp(c->type, ptype+1, 2))
+      continue;
+    // if type is not specified, output everything except "wl" and "fl" records
+    if (!c->type_specified && (!strncmp("wl", ptype+1, 2) || !strncmp("fl", ptype+1, 2)))
+      continue;
+    return line;
+  }
+}
+
+/** Job step of /jl: fill the buffer with as many records as fit */
+static bool server_log_step(ResponseJob *j, BufferFiller &out) {
+  CBORWriter w(out);
+  char *line;
+  uint16_t len;
+  while((line=log_next_record(&j->log, &len))) {
+    if(out.position()+len+LOG_RECORD_SLACK>=JOB_BUFFER_SIZE) {
+      // output it with the next buffer
+      j->log.line = line;
+      j->log.line_len = len;
+      return true;
+    }
+    if(j->cbor) {
+      server_cbor_log_record(w, line);
+      continue;
+    }
+    // if this is the first record, do not print comma
+    if (j->comma)  out.emit_p(PSTR(","));
+    else {j->comma=1;}
+    out.emit_mem(line, len);
+  }
+  if(j->cbor) w.end();
+  else out.emit_p(PSTR("]"));
+  return false;
 }
 
 /**
@@ -1398,11 +2541,11 @@ int file_fgets(File file, char* buf, int maxsize) {
  * type:  type of log records (optional)
  *        rs, rd, wl
  *        if unspecified, output all records
+ * The response is produced by a job, see server_job_loop
  */
 void server_json_log() {
 
   char* p = NULL;
-  if(!process_password()) return;  
 
   // if no sd card, return false
   if (!os.status.has_sd)  handle_return(HTML_PAGE_NOT_FOUND);
@@ -1430,72 +2573,65 @@ void server_json_log() {
     if ((start>end) || (end-start)>365)  handle_return(HTML_DATA_OUTOFBOUND);
   }
 
+  server_accepts_cbor(false);
+  ResponseJob *j = server_job_start(server_log_step);
+  if (!j) handle_return(HTML_NOT_PERMITTED);
+
   // extract the type parameter
-  char type[4] = {0};
-  bool type_specified = false;
-  if (findKeyVal(p, type, 4, PSTR("type"), true))
-    type_specified = true;
+  LogCursor *c = &j->log;
+  c->day = start;
+  c->end = end;
+  c->open = false;
+  c->line = NULL;
+  memset(c->type, 0, sizeof(c->type));
+  c->type_specified = findKeyVal(p, c->type, 4, PSTR("type"), true);
 
-  // as the log data can be large, we will use ESP8266's sendContent function to
-  // send multiple packets of data, instead of the standard way of using send().
-  rewind_ether_buffer();
-  bfill.emit_p(PSTR("$F$F$F$F\r\n"), html200OK, htmlContentJSON, htmlAccessControl, htmlNoCache);
-  wifi_server->sendContent(ether_buffer);
-  rewind_ether_buffer();
+  BufferFiller f(j->buf+j->len, JOB_BUFFER_SIZE-j->len);
+  if(j->cbor) CBORWriter(f).array();
+  else f.emit_p(PSTR("["));
+  j->len += f.position();
+}
 
-  bfill.emit_p(PSTR("["));
+/**
+ * Output relay actuation trace
+ * Command: /jt?pw=xxx&since=xxx&dump=x
+ *
+ * pw:    password
+ * since: only output records with sequence number >= since (optional)
+ * dump:  if 1, also write the trace to flash (optional)
+ *
+ * Records are in the form of [seq,ms,sid,state,cause]
+ */
+void server_json_trace() {
+  char* p = NULL;
 
-  bool comma = 0;
-  for(int i=start;i<=end;i++) {
-    itoa(i, tmp_buffer, 10);
-    make_logfile_name(tmp_buffer);
-
-    File file = SPIFFS.open(tmp_buffer, "r");
-    if(!file) continue;
-   // prepare to open log file
-
-    int res;
-    while(true) {
-      // do not use file.readBytes or readBytesUntil because it's very slow
-      int res = file_fgets(file, tmp_buffer, TMP_BUFFER_SIZE);
-      if (res <= 0) {
-        file.close();
-        break;
-      }
-      tmp_buffer[res]=0;
-      // check record type
-      // records are all in the form of [x,"xx",...]
-      // where x is program index (>0) if this is a station record
-      // and "xx" is the type name if this is a special record (e.g. wl, fl, rs)
-
-      // search string until we find the first comma
-      char *ptype = tmp_buffer;
-      tmp_buffer[TMP_BUFFER_SIZE-1]=0; // make sure the search will end
-      while(*ptype && *ptype != ',') ptype++;
-      if(*ptype != ',') continue; // didn't find comma, move on
-      ptype++;  // move past comma
-
-      if (type_specified && strncmp(type, ptype+1, 2))
-        continue;
-      // if type is not specified, output everything except "wl" and "fl" records
-      if (!type_specified && (!strncmp("wl", ptype+1, 2) || !strncmp("fl", ptype+1, 2)))
-        continue;
-      // if this is the first record, do not print comma
-      if (comma)  bfill.emit_p(PSTR(","));
-      else {comma=1;}
-      bfill.emit_p(PSTR("$S"), tmp_buffer);
-      // if the available ether buffer size is getting small
-      // push out a packet
-      if (available_ether_buffer() < 80) {
-        send_packet();
-      }
-    }
+  ulong seq = 0;
+  if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("since"), true)) {
+    seq = strtoul(tmp_buffer, NULL, 10);
+  }
+  if (findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("dump"), true) && atoi(tmp_buffer)) {
+    if (!os.status.has_sd || !relaytrace_dump()) handle_return(HTML_NOT_PERMITTED);
   }
 
-  bfill.emit_p(PSTR("]"));
-  INSERT_DELAY(1);
-  send_packet(true);
+  ulong head = relaytrace_head();
+  if (head>RELAY_TRACE_SIZE && seq<head-RELAY_TRACE_SIZE)  seq = head-RELAY_TRACE_SIZE;
+
+  rewind_ether_buffer();
+  print_json_header(false);
+  // current time in seconds and millis, for converting record times to wall time
+  bfill.emit_p(PSTR("{\"now\":$L,\"ms\":$L,\"next\":$L,\"trace\":["), os.now_tz(), millis(), head);
+  RelayTraceRecord rec;
+  bool comma = 0;
+  for(;seq<head;seq++) {
+    if(!relaytrace_get(seq, &rec)) continue;
+    if (comma)  bfill.emit_p(PSTR(","));
+    else {comma=1;}
+    bfill.emit_p(PSTR("[$L,$L,$D,$D,$D]"), seq, rec.ms, rec.sid, rec.state, rec.cause);
+  }
+  bfill.emit_p(PSTR("]}"));
+  handle_return(HTML_OK);
 }
+
 /**
  * Delete log
  * Command: /dl?pw=xxx&day=xxx
@@ -1507,7 +2643,6 @@ void server_json_log() {
  */
 void server_delete_log() {
   char* p = NULL;
-  if(!process_password()) return;
 
   if (!findKeyVal(p, tmp_buffer, TMP_BUFFER_SIZE, PSTR("day"), true))
     handle_return(HTML_DATA_MISSING);
@@ -1517,105 +2652,608 @@ void server_delete_log() {
   handle_return(HTML_SUCCESS);
 }
 
+/** CBOR encoding
+ * The same data as the JSON output of /ja and /jp, encoded by CBORWriter.
+ * Objects become maps with the same keys, "wto" is kept as the JSON text it
+ * is stored in.
+ */
+void server_cbor_programs_main(CBORWriter &w) {
+  w.map();
+  w.text_p(PSTR("nprogs")); w.uint(pd.nprograms);
+  w.text_p(PSTR("nboards")); w.uint(os.nboards);
+  w.text_p(PSTR("mnp")); w.uint(MAX_NUMBER_PROGRAMS);
+  w.text_p(PSTR("mnst")); w.uint(MAX_NUM_STARTTIMES);
+  w.text_p(PSTR("pnsize")); w.uint(PROGRAM_NAME_SIZE);
+  w.text_p(PSTR("pd"));
+  w.array(pd.nprograms);
+  byte pid, i;
+  ProgramStruct prog;
+  for(pid=0;pid<pd.nprograms;pid++) {
+    pd.read(pid, &prog);
+    if (prog.type == PROGRAM_TYPE_INTERVAL && prog.days[1] > 1) {
+      pd.drem_to_relative(prog.days);
+    }
+    w.array(6);
+    w.uint(*(byte*)(&prog));
+    w.uint(prog.days[0]);
+    w.uint(prog.days[1]);
+    w.array(MAX_NUM_STARTTIMES);
+    for (i=0;i<MAX_NUM_STARTTIMES;i++)  w.integer(prog.starttimes[i]);
+    w.array(os.nstations);
+    for (i=0;i<os.nstations;i++)  w.uint(prog.durations[i]);
+    w.text(prog.name, strnlen(prog.name, PROGRAM_NAME_SIZE));
+  }
+  w.end();
+  INSERT_DELAY(1);
+}
+
+void server_cbor_options_main(CBORWriter &w) {
+  w.map();
+  byte oid;
+  for(oid=0;oid<NUM_OPTIONS;oid++) {
+    int32_t v=os.options[oid];
+    if (oid==OPTION_MASTER_OFF_ADJ || oid==OPTION_MASTER_OFF_ADJ_2 ||
+        oid==OPTION_MASTER_ON_ADJ  || oid==OPTION_MASTER_ON_ADJ_2 ||
+        oid==OPTION_STATION_DELAY_TIME) {
+      v=water_time_decode_signed(v);
+    }
+    if (oid==OPTION_BOOST_TIME) {
+      if (os.hw_type==HW_TYPE_AC || os.hw_type==HW_TYPE_UNKNOWN) continue;
+      else v<<=2;
+    }
+    if (oid==OPTION_SEQUENTIAL_RETIRED) continue;
+    if (oid==OPTION_DEVICE_ID && os.status.has_hwmac) continue;
+    if(oid==OPTION_LCD_CONTRAST || oid==OPTION_LCD_BACKLIGHT || oid==OPTION_LCD_DIMMING) continue;
+
+    strncpy_P0(tmp_buffer, op_json_names+oid*5, 5);
+    w.text(tmp_buffer);
+    w.integer(v);
+  }
+  w.text_p(PSTR("dexp")); w.uint(MAX_EXT_BOARDS);
+  w.text_p(PSTR("mexp")); w.uint(MAX_EXT_BOARDS);
+  w.text_p(PSTR("hwt")); w.uint(os.hw_type);
+  w.end();
+}
+
+void server_cbor_stations_attrib(CBORWriter &w, PGM_P name, int addr) {
+  byte *attrib = (byte*)tmp_buffer;
+  os.station_attrib_bits_load(addr, attrib);
+  w.text_p(name);
+  w.array(os.nboards);
+  for(byte i=0;i<os.nboards;i++)  w.uint(attrib[i]);
+}
+
+void server_cbor_stations_main(CBORWriter &w) {
+  w.map();
+  server_cbor_stations_attrib(w, PSTR("masop"), ADDR_NVM_MAS_OP);
+  server_cbor_stations_attrib(w, PSTR("ignore_rain"), ADDR_NVM_IGNRAIN);
+  server_cbor_stations_attrib(w, PSTR("masop2"), ADDR_NVM_MAS_OP_2);
+  server_cbor_stations_attrib(w, PSTR("stn_dis"), ADDR_NVM_STNDISABLE);
+  server_cbor_stations_attrib(w, PSTR("stn_seq"), ADDR_NVM_STNSEQ);
+  if (os.status.has_sd) {
+    server_cbor_stations_attrib(w, PSTR("stn_spe"), ADDR_NVM_STNSPE);
+  }
+  w.text_p(PSTR("snames"));
+  w.array(os.nstations);
+  for(byte sid=0;sid<os.nstations;sid++) {
+    os.get_station_name(sid, tmp_buffer);
+    w.text(tmp_buffer);
+  }
+  w.text_p(PSTR("maxlen")); w.uint(STATION_NAME_SIZE);
+  w.end();
+  INSERT_DELAY(1);
+}
+
+void server_cbor_status_main(CBORWriter &w) {
+  w.map();
+  w.text_p(PSTR("sn"));
+  w.array(os.nstations);
+  for (byte sid=0;sid<os.nstations;sid++) {
+    w.uint((os.station_bits[(sid>>3)]>>(sid&0x07))&1);
+  }
+  w.text_p(PSTR("nstations")); w.uint(os.nstations);
+  w.end();
+}
+
+void server_cbor_controller_main(CBORWriter &w) {
+  byte bid, sid;
+  ulong curr_time = os.now_tz();
+  w.map();
+  w.text_p(PSTR("devt")); w.uint(curr_time);
+  w.text_p(PSTR("nbrd")); w.uint(os.nboards);
+  w.text_p(PSTR("en")); w.uint(os.status.enabled);
+  w.text_p(PSTR("rd")); w.uint(os.status.rain_delayed);
+  w.text_p(PSTR("rs")); w.uint(os.status.rain_sensed);
+  w.text_p(PSTR("rdst")); w.uint(os.nvdata.rd_stop_time);
+  w.text_p(PSTR("loc")); w.text_nvm((const byte*)ADDR_NVM_LOCATION);
+  w.text_p(PSTR("wtkey")); w.text_nvm((const byte*)ADDR_NVM_WEATHER_KEY);
+  w.text_p(PSTR("sunrise")); w.uint(os.nvdata.sunrise_time);
+  w.text_p(PSTR("sunset")); w.uint(os.nvdata.sunset_time);
+  w.text_p(PSTR("eip")); w.uint(os.nvdata.external_ip);
+  w.text_p(PSTR("lwc")); w.uint(os.checkwt_lasttime);
+  w.text_p(PSTR("lswc")); w.uint(os.checkwt_success_lasttime);
+  w.text_p(PSTR("lupt")); w.uint(os.powerup_lasttime);
+  w.text_p(PSTR("lrun"));
+  w.array(4);
+  w.uint(pd.lastrun.station);
+  w.uint(pd.lastrun.program);
+  w.uint(pd.lastrun.duration);
+  w.uint(pd.lastrun.endtime);
+  if(os.options[OPTION_SENSOR2_TYPE]==SENSOR_TYPE_FLOW) {
+    w.text_p(PSTR("flcrt")); w.uint(os.flowcount_rt);
+    w.text_p(PSTR("flwrt")); w.uint(FLOWCOUNT_RT_WINDOW);
+  }
+  w.text_p(PSTR("sbits"));
+  w.array(os.nboards+1);
+  for(bid=0;bid<os.nboards;bid++)  w.uint(os.station_bits[bid]);
+  w.uint(0);
+  w.text_p(PSTR("ps"));
+  w.array(os.nstations);
+  for(sid=0;sid<os.nstations;sid++) {
+    unsigned long rem = 0;
+    byte qid = pd.station_qid[sid];
+    RuntimeQueueStruct *q = pd.queue + qid;
+    if (qid<255) {
+      rem = (curr_time >= q->st) ? (q->st+q->dur-curr_time) : q->dur;
+      if(rem>65535) rem = 0;
+    }
+    w.array(3);
+    w.uint((qid<255)?q->pid:0);
+    w.uint(rem);
+    w.uint((qid<255)?q->st:0);
+  }
+  if(read_from_file(wtopts_filename, tmp_buffer)) {
+    w.text_p(PSTR("wto"));
+    w.text(tmp_buffer);
+  }
+  if(read_from_file(ifkey_filename, tmp_buffer)) {
+    w.text_p(PSTR("ifkey"));
+    w.text(tmp_buffer);
+  }
+  w.text_p(PSTR("RSSI")); w.integer((int16_t)WiFi.RSSI());
+  w.end();
+  INSERT_DELAY(1);
+}
+
+/** Encode a log record line ([x,"xx",...]) as a CBOR array
+ * Returns false, without output, if the line is not a well-formed record
+ */
+bool server_cbor_log_record(CBORWriter &w, char *line) {
+  #define LOG_RECORD_MAX_FIELDS 6
+  char *fields[LOG_RECORD_MAX_FIELDS];
+  byte n = 0;
+  char *p = line;
+  if(*p++!='[') return false;
+  while(n<LOG_RECORD_MAX_FIELDS) {
+    while(*p==' ') p++;
+    fields[n++] = p;
+    if(*p=='"') {
+      p = strchr(p+1, '"');
+      if(!p) return false;
+      p++;
+    } else {
+      while(*p && *p!=',' && *p!=']') p++;
+    }
+    if(*p==']') break;
+    if(*p!=',') return false;
+    p++;
+  }
+  if(*p!=']') return false;
+  w.array(n);
+  for(byte i=0;i<n;i++) {
+    char *f = fields[i];
+    if(*f=='"') {
+      w.text(f+1, strchr(f+1, '"')-f-1);
+    } else {
+      char *e;
+      long v = strtol(f, &e, 10);
+      if(*e=='.') w.real(atof(f));
+      else w.integer(v);
+    }
+  }
+  return true;
+}
+
 /** Output all JSON data, including jc, jp, jo, js, jn */
 void server_json_all() {
-  if(!process_password(true)) return;
   rewind_ether_buffer();
+  if(server_accepts_cbor()) {
+    print_json_header();
+    CBORWriter w(bfill);
+    w.map();
+    w.text_p(PSTR("settings"));
+    server_cbor_controller_main(w);
+    w.text_p(PSTR("programs"));
+    server_cbor_programs_main(w);
+    w.text_p(PSTR("options"));
+    server_cbor_options_main(w);
+    w.text_p(PSTR("status"));
+    server_cbor_status_main(w);
+    w.text_p(PSTR("stations"));
+    server_cbor_stations_main(w);
+    w.end();
+    handle_return(HTML_OK);
+  }
   print_json_header();
   bfill.emit_p(PSTR("\"settings\":{"));
   server_json_controller_main();
-  send_packet();
   bfill.emit_p(PSTR(",\"programs\":{"));
-  server_json_programs_main();
-  send_packet();
+  server_json_section(JSON_SECTION_PROGRAMS);
   bfill.emit_p(PSTR(",\"options\":{"));
-  server_json_options_main();
-  send_packet();
+  server_json_section(JSON_SECTION_OPTIONS);
   bfill.emit_p(PSTR(",\"status\":{"));
   server_json_status_main();
-  send_packet();
   bfill.emit_p(PSTR(",\"stations\":{"));
-  server_json_stations_main();
+  server_json_section(JSON_SECTION_STATIONS);
   bfill.emit_p(PSTR("}"));
   INSERT_DELAY(1);
   handle_return(HTML_OK);
 }
 
-typedef void (*URLHandler)(void);
+/** Route flags */
+#define ROUTE_PW       0x01   // password required
+#define ROUTE_PW_FWV   0x03   // password required, output fwv if the password check fails
+#define ROUTE_HEAVY    0x04   // expensive request, see server_admit
+
+/** Server command route */
+struct URLRoute {
+  char key[3];          // two-character command
+  URLHandler handler;   // handler function
+  byte flags;           // route flags
+  HTTPMethod method;    // accepted HTTP method
+};
 
-/* Server function urls
- * To save RAM space, each GET command keyword is exactly
- * 2 characters long, with no ending 0
- * The order must exactly match the order of the
- * handler functions below
+/* Server command routes
+ * Each command keyword is exactly 2 characters long.
+ * Requests are dispatched by a perfect hash of the two characters,
+ * which is verified at compile time.
  */
-const char _url_keys[] PROGMEM =
-  "cv"
-  "jc"
-  "dp"
-  "cp"
-  "cr"
-  "mp"
-  "up"
-  "jp"
-  "co"
-  "jo"
-  "sp"
-  "js"
-  "cm"
-  "cs"
-  "jn"
-  "je"
-  "jl"
-  "dl"
-  "su"
-  "cu"
-  "ja";
-
-// Server function handlers
-URLHandler urls[] = {
-  server_change_values,   // cv
-  server_json_controller, // jc
-  server_delete_program,  // dp
-  server_change_program,  // cp
-  server_change_runonce,  // cr
-  server_manual_program,  // mp  
-  server_moveup_program,  // up
-  server_json_programs,   // jp
-  server_change_options,  // co
-  server_json_options,    // jo
-  server_change_password, // sp
-  server_json_status,     // js
-  server_change_manual,   // cm
-  server_change_stations, // cs
-  server_json_stations,   // jn
-  server_json_station_special,// je
-  server_json_log,        // jl
-  server_delete_log,      // dl
-  server_view_scripturl,  // su
-  server_change_scripturl,// cu
-  server_json_all         // ja
+void server_json_metrics();
+
+constexpr URLRoute url_routes[] = {
+  {"cv", server_change_values,                 ROUTE_PW,      HTTP_ANY},
+  {"jc", server_json_controller,               ROUTE_PW,      HTTP_GET},
+  {"dp", server_delete_program,                ROUTE_PW,      HTTP_ANY},
+  {"cp", server_change_program,                ROUTE_PW,      HTTP_ANY},
+  {"cr", server_change_runonce,                ROUTE_PW,      HTTP_ANY},
+  {"mp", server_manual_program,                ROUTE_PW,      HTTP_ANY},
+  {"up", server_moveup_program,                ROUTE_PW,      HTTP_ANY},
+  {"jp", server_json_programs,                 ROUTE_PW,      HTTP_GET},
+  {"co", server_change_options,                ROUTE_PW,      HTTP_ANY},
+  {"jo", server_json_options,                  ROUTE_PW_FWV,  HTTP_GET},
+  {"sp", server_change_password,               ROUTE_PW,      HTTP_ANY},
+  {"js", server_json_status,                   ROUTE_PW,      HTTP_GET},
+  {"cm", server_change_manual,                 ROUTE_PW,      HTTP_ANY},
+  {"cs", server_change_stations,               ROUTE_PW,      HTTP_ANY},
+  {"jn", server_json_stations,                 ROUTE_PW,      HTTP_GET},
+  {"je", server_json_station_special,          ROUTE_PW,      HTTP_GET},
+  {"jl", server_json_log,                      ROUTE_PW|ROUTE_HEAVY, HTTP_GET},
+  {"dl", server_delete_log,                    ROUTE_PW,      HTTP_ANY},
+  {"su", server_view_scripturl,                0,             HTTP_GET},
+  {"cu", server_change_scripturl,              ROUTE_PW,      HTTP_ANY},
+  {"ja", server_json_all,                      ROUTE_PW_FWV|ROUTE_HEAVY, HTTP_GET},
+  {"jd", server_json_delta,                    ROUTE_PW,      HTTP_GET},
+  {"ev", server_event_stream,                  ROUTE_PW,      HTTP_GET},
+  {"tk", server_session_token,                 ROUTE_PW,      HTTP_ANY},
+  {"cb", server_batch,                         ROUTE_PW|ROUTE_HEAVY, HTTP_POST},
+#if defined(ENABLE_SERVER_METRICS)
+  {"jm", server_json_metrics,                  ROUTE_PW,      HTTP_GET},
+#endif
+  {"jt", server_json_trace,                    ROUTE_PW,      HTTP_GET}
+};
+#define URL_NUM_ROUTES  (sizeof(url_routes)/sizeof(url_routes[0]))
+#define URL_HASH_SIZE   43
+
+constexpr byte url_hash(char c0, char c1) {
+  return ((byte)c0*11 + (byte)c1) % URL_HASH_SIZE;
+}
+
+constexpr bool url_hash_unique(unsigned i, unsigned j) {
+  return j>=URL_NUM_ROUTES || (url_hash(url_routes[i].key[0], url_routes[i].key[1]) !=
+                               url_hash(url_routes[j].key[0], url_routes[j].key[1]) && url_hash_unique(i, j+1));
+}
+
+constexpr bool url_hash_perfect(unsigned i=0) {
+  return i>=URL_NUM_ROUTES || (url_hash_unique(i, i+1) && url_hash_perfect(i+1));
+}
+
+static_assert(url_hash_perfect(), "url hash has collisions, adjust URL_HASH_SIZE or the multiplier");
+
+#if defined(ENABLE_SERVER_METRICS)
+/** Web server metrics
+ * Every routed command, and each handler registered with wifi_server->on,
+ * has a metric: request count, failed requests, response bytes and service
+ * time (min, mean, max, and an upper bound of p99 from a histogram with
+ * power-of-2 buckets).
+ * Free heap is sampled before and after each request; a request that
+ * leaves less free heap than it found is counted as holding memory.
+ * Steady-state requests should hold none, as responses are built in
+ * ether_buffer or on the stack rather than in Strings.
+ * Compiled out unless ENABLE_SERVER_METRICS is defined.
+ */
+#define METRIC_HOME        (URL_NUM_ROUTES+0)
+#define METRIC_UPDATE      (URL_NUM_ROUTES+1)
+#define METRIC_UPLOAD      (URL_NUM_ROUTES+2)
+#define METRIC_AP_HOME     (URL_NUM_ROUTES+3)
+#define METRIC_AP_SCAN     (URL_NUM_ROUTES+4)
+#define METRIC_AP_CONFIG   (URL_NUM_ROUTES+5)
+#define METRIC_AP_CONNECT  (URL_NUM_ROUTES+6)
+#define NUM_METRICS        (URL_NUM_ROUTES+7)
+#define METRIC_BUCKETS     16     // service time buckets: <128us, <256us, ... >=2s
+#define METRIC_BUCKET0_US  128
+
+// names of the handlers that are not routed, each takes 8 characters
+static const char metric_names[] PROGMEM =
+  "home\0\0\0\0"
+  "update\0\0"
+  "upload\0\0"
+  "ap_home\0"
+  "jsap\0\0\0\0"
+  "ccap\0\0\0\0"
+  "jtap\0\0\0\0";
+
+struct RouteMetrics {
+  ulong count;
+  ulong errors;
+  ulong bytes;
+  ulong tmin, tmax;     // service time (us)
+  uint64_t tsum;
+  uint16_t hist[METRIC_BUCKETS];
+  ulong held;           // requests after which free heap was lower than before
+};
+
+static RouteMetrics metrics[NUM_METRICS];
+static ulong metrics_t0;
+static uint32_t metrics_heap_before, metrics_heap_after, metrics_heap_min = 0xFFFFFFFF;
+
+void metrics_begin(byte id) {
+  metrics_current = id;
+  metrics_bytes = 0;
+  metrics_error = false;
+  metrics_heap_before = ESP.getFreeHeap();
+  metrics_t0 = micros();
+}
+
+void metrics_end() {
+  ulong t = micros()-metrics_t0;
+  RouteMetrics *m = metrics+metrics_current;
+  if(!m->count || t<m->tmin) m->tmin = t;
+  if(t>m->tmax) m->tmax = t;
+  m->count++;
+  m->tsum += t;
+  m->bytes += metrics_bytes;
+  if(metrics_error) m->errors++;
+  byte b = 0;
+  for(ulong lim=METRIC_BUCKET0_US;t>=lim && b<METRIC_BUCKETS-1;lim<<=1) b++;
+  if(m->hist[b]==0xFFFF) {
+    // keep the shape of the histogram when a bucket is full
+    for(byte i=0;i<METRIC_BUCKETS;i++)  m->hist[i] >>= 1;
+  }
+  m->hist[b]++;
+  metrics_heap_after = ESP.getFreeHeap();
+  if(metrics_heap_after<metrics_heap_before) m->held++;
+  if(metrics_heap_before<metrics_heap_min) metrics_heap_min = metrics_heap_before;
+  if(metrics_heap_after<metrics_heap_min) metrics_heap_min = metrics_heap_after;
+}
+
+void metrics_add_bytes(byte id, ulong n) {
+  metrics[id].bytes += n;
+}
+
+/** Upper bound (us) of the 99th percentile
+ * The upper bound of the bucket holding it, capped at the maximum seen
+ */
+static ulong metrics_p99(const RouteMetrics *m) {
+  ulong total = 0;
+  byte b;
+  for(b=0;b<METRIC_BUCKETS;b++)  total += m->hist[b];
+  ulong rank = total - total/100, n = 0;
+  for(b=0;b<METRIC_BUCKETS-1;b++) {
+    n += m->hist[b];
+    if(n>=rank) break;
+  }
+  if(b==METRIC_BUCKETS-1) return m->tmax;
+  ulong bound = (ulong)METRIC_BUCKET0_US<<b;
+  return (bound<m->tmax) ? bound : m->tmax;
+}
+
+/** Heap fragmentation in percent (0: the free heap is one block)
+ * max_block is set to the size of the largest free block.
+ */
+static byte metrics_heap_frag(ulong &max_block) {
+#if defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3)
+  max_block = ESP.getMaxFreeBlockSize();
+  return ESP.getHeapFragmentation();
+#else
+  umm_info(NULL, 0);
+  max_block = (ulong)ummHeapInfo.maxFreeContiguousBlocks*UMM_BLOCK_BYTES;
+  ulong free_bytes = (ulong)ummHeapInfo.freeBlocks*UMM_BLOCK_BYTES;
+  return free_bytes ? 100-max_block*100/free_bytes : 0;
+#endif
+}
+
+/**
+ * Output web server metrics
+ * Command: /jm?pw=xxx
+ *
+ * pw: password
+ * Returns free heap (now, before and after the last request, and the
+ * minimum seen), heap fragmentation (percent, and the largest free block),
+ * and for each handler that has served requests:
+ * [name,count,errors,bytes,min,mean,max,p99,held] with times in microseconds,
+ * p99 an upper bound (bucket bound, capped at max), and held the number of
+ * requests that left less free heap behind
+ */
+void server_json_metrics() {
+  rewind_ether_buffer();
+  print_json_header();
+  ulong max_block;
+  byte frag = metrics_heap_frag(max_block);
+  bfill.emit_p(PSTR("\"heap\":[$L,$L,$L,$L],\"frag\":[$D,$L],\"metrics\":["),
+               (ulong)ESP.getFreeHeap(), (ulong)metrics_heap_before, (ulong)metrics_heap_after, (ulong)metrics_heap_min,
+               frag, max_block);
+  bool comma = 0;
+  for(byte id=0;id<NUM_METRICS;id++) {
+    const RouteMetrics *m = metrics+id;
+    if(!m->count) continue;
+    if (comma) bfill.emit_p(PSTR(","));
+    else {comma=1;}
+    if(id<URL_NUM_ROUTES) {
+      char name[3] = {url_routes[id].key[0], url_routes[id].key[1], 0};
+      bfill.emit_p(PSTR("[\"$S\","), name);
+    } else {
+      bfill.emit_p(PSTR("[\"$F\","), metric_names+(id-URL_NUM_ROUTES)*8);
+    }
+    bfill.emit_p(PSTR("$L,$L,$L,$L,$L,$L,$L,$L]"), m->count, m->errors, m->bytes,
+                 m->tmin, (ulong)(m->tsum/m->count), m->tmax, metrics_p99(m), m->held);
+  }
+  bfill.emit_p(PSTR("]}"));
+  handle_return(HTML_OK);
+}
+/** Wrap a handler registered with wifi_server->on */
+template<byte id, void (*handler)()> void metered() {
+  metrics_begin(id);
+  handler();
+  metrics_end();
+}
+  #define METERED(id, handler)  metered<id, handler>
+#else
+  #define METERED(id, handler)  handler
+#endif
+
+#if defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3)
+  typedef RequestHandler<WiFiServer> URLRequestHandler;
+  typedef const String& URLRequestUri;
+#else
+  typedef RequestHandler URLRequestHandler;
+  typedef String URLRequestUri;
+#endif
+
+/** Request headers used by the commands */
+const char *url_headers[] = {"If-None-Match", "Accept"};
+
+/** Request handler that dispatches all server commands
+ * The web server walks its handler list for every request,
+ * so all commands are served by this single handler.
+ */
+class URLRouter : public URLRequestHandler {
+  byte slots[URL_HASH_SIZE];  // route index+1 of each hash slot (0: unused)
+
+  const URLRoute* route(HTTPMethod method, URLRequestUri uri) {
+    if(uri.length()!=3 || uri[0]!='/') return NULL;
+    byte r = slots[url_hash(uri[1], uri[2])];
+    if(!r) return NULL;
+    const URLRoute *rt = url_routes+r-1;
+    if(rt->key[0]!=uri[1] || rt->key[1]!=uri[2]) return NULL;
+    if(rt->method!=HTTP_ANY && rt->method!=method) return NULL;
+    return rt;
+  }
+
+public:
+  URLRouter() {
+    memset(slots, 0, sizeof(slots));
+    for(byte i=0;i<URL_NUM_ROUTES;i++)
+      slots[url_hash(url_routes[i].key[0], url_routes[i].key[1])] = i+1;
+  }
+
+  bool canHandle(HTTPMethod method, URLRequestUri uri) override {
+    return route(method, uri)!=NULL;
+  }
+
+  bool handle(ESP8266WebServer& server, HTTPMethod method, URLRequestUri uri) override {
+    const URLRoute *rt = route(method, uri);
+    if(!rt) return false;
+#if defined(ENABLE_SERVER_METRICS)
+    metrics_begin(rt-url_routes);
+#endif
+    if(!server_admit(rt->flags&ROUTE_HEAVY)) {
+      server_send_throttled();
+    } else {
+      ulong t0 = micros();
+      query_parse();
+      ether_etag = false;
+      ether_cbor = false;
+      ether_json = false;
+      if(!(rt->flags&ROUTE_PW) || process_password((rt->flags&ROUTE_PW_FWV)==ROUTE_PW_FWV)) {
+        rt->handler();
+      }
+      http_budget_charge(t0);
+    }
+#if defined(ENABLE_SERVER_METRICS)
+    metrics_end();
+#endif
+    return true;
+  }
 };
 
 // handle Ethernet request
 void on_ap_update() {
-  String html = FPSTR(ap_update_html);
-  server_send_html(html);
+  server_send_gz(ap_update_html_gz, sizeof(ap_update_html_gz));
 }
 
 void on_sta_update() {
-  String html = FPSTR(sta_update_html);
-  server_send_html(html);
+  server_send_gz(sta_update_html_gz, sizeof(sta_update_html_gz));
+}
+
+/** Firmware upload (OTA)
+ * The image is written to flash as it streams in, and the core's Updater
+ * hashes each chunk as it is written. The expected size (size=) and, if
+ * known, the MD5 digest of the image (md5=) are given in the query string
+ * of the POST, so they are known before the first chunk arrives. An image
+ * that does not fit, has a bad header or runs past the announced size is
+ * rejected at once: the result is sent with the failing item and the
+ * connection is closed, instead of receiving the rest of the image.
+ * The digest is checked by Update.end without reading the image back.
+ */
+#define OTA_REPORT_STEP  10   // report progress every 10%
+
+struct OTAState {
+  ulong expected;       // announced size (0: not given)
+  ulong received;
+  ulong t0;             // millis() at the first chunk
+  byte next_report;     // progress (percent) of the next report
+  bool failed;          // result has been sent already
+};
+static OTAState ota;
+
+/** Give up on an upload and tell the client why */
+static void ota_fail(const char *item) {
+  Update.end();
+  ota.failed = true;
+  DEBUG_PRINT(F("upload failed: "));
+  DEBUG_PRINTLN(item);
+  server_send_result(HTML_UPLOAD_FAILED, item);
+  wifi_server->client().stop();
+}
+
+static void ota_report() {
+  ulong t = millis()-ota.t0;
+  DEBUG_PRINT(ota.received);
+  DEBUG_PRINT(F(" bytes "));
+  if(ota.expected) {
+    DEBUG_PRINT(ota.received*100/ota.expected);
+    DEBUG_PRINT(F("% "));
+  }
+  DEBUG_PRINT(t ? ota.received/t : 0);  // bytes per ms is about KB/s
+  DEBUG_PRINTLN(F(" KB/s"));
 }
 
 void on_sta_upload_fin() {
+  if(ota.failed) return;
+  query_parse();
   if(!process_password()) {
     //Update.reset();
     return;
   }
-  // finish update and check error
+  if(ota.expected && ota.received!=ota.expected) {
+    Update.end();
+    server_send_result(HTML_UPLOAD_FAILED, "size");
+    return;
+  }
+  // finish update and check error (including the MD5 digest, if given)
   if(!Update.end(true) || Update.hasError()) {
-    handle_return(HTML_UPLOAD_FAILED);
+    server_send_result(HTML_UPLOAD_FAILED, Update.getError()==UPDATE_ERROR_MD5 ? "md5" : NULL);
+    return;
   }
   
   server_send_result(HTML_SUCCESS);
@@ -1630,49 +3268,54 @@ void on_sta_upload() {
     WiFiUDP::stopAll();
     DEBUG_PRINT(F("upload: "));
     DEBUG_PRINTLN(upload.filename);
+    memset(&ota, 0, sizeof(ota));
+    ota.t0 = millis();
+    ota.next_report = OTA_REPORT_STEP;
+    query_parse();
+    if(findKeyVal(NULL, tmp_buffer, TMP_BUFFER_SIZE, PSTR("size"), true))
+      ota.expected = strtoul(tmp_buffer, NULL, 10);
     uint32_t maxSketchSpace = (ESP.getFreeSketchSpace()-0x1000)&0xFFFFF000;
-    if(!Update.begin(maxSketchSpace)) {
+    if(ota.expected>maxSketchSpace) {
+      ota_fail("size");
+      return;
+    }
+    if(!Update.begin(ota.expected ? ota.expected : maxSketchSpace)) {
       DEBUG_PRINT(F("begin failed "));
       DEBUG_PRINTLN(maxSketchSpace);
+      ota_fail("begin");
+      return;
     }
-    
-  } else if(upload.status == UPLOAD_FILE_WRITE) {
-    DEBUG_PRINT(".");
-    if(Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-      DEBUG_PRINTLN(F("size mismatch"));
+    if(findKeyVal(NULL, tmp_buffer, TMP_BUFFER_SIZE, PSTR("md5"), true)) {
+      // the Updater compares lower case hex digits
+      for(char *c=tmp_buffer;*c;c++) *c = tolower(*c);
+      if(!Update.setMD5(tmp_buffer)) {
+        ota_fail("md5");
+        return;
+      }
     }
-      
-  } else if(upload.status == UPLOAD_FILE_END) {
-    
-    DEBUG_PRINTLN(F("completed"));
-   
-  } else if(upload.status == UPLOAD_FILE_ABORTED){
-    Update.end();
-    DEBUG_PRINTLN(F("aborted"));
-  }
-  delay(0);    
-}
 
-void on_ap_upload() { 
-  HTTPUpload& upload = wifi_server->upload();
-  if(upload.status == UPLOAD_FILE_START){
-    DEBUG_PRINT(F("upload: "));
-    DEBUG_PRINTLN(upload.filename);
-    uint32_t maxSketchSpace = (ESP.getFreeSketchSpace()-0x1000)&0xFFFFF000;
-    if(!Update.begin(maxSketchSpace)) {
-      DEBUG_PRINTLN(F("begin failed"));
-      DEBUG_PRINTLN(maxSketchSpace);      
-    }
   } else if(upload.status == UPLOAD_FILE_WRITE) {
-    DEBUG_PRINT(".");
+    if(ota.failed) return;
+    ota.received += upload.currentSize;
+    if(ota.expected && ota.received>ota.expected) {
+      ota_fail("size");
+      return;
+    }
+    // the first chunk is checked for the image header as it is written
     if(Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
-      DEBUG_PRINTLN(F("size mismatch"));
+      ota_fail(Update.getError()==UPDATE_ERROR_MAGIC_BYTE ? "image" : "write");
+      return;
+    }
+    if(ota.expected && ota.received*100>=(ulong)ota.next_report*ota.expected) {
+      ota_report();
+      ota.next_report += OTA_REPORT_STEP;
     }
-      
+
   } else if(upload.status == UPLOAD_FILE_END) {
-    
+    if(ota.failed) return;
+    ota_report();
     DEBUG_PRINTLN(F("completed"));
-       
+
   } else if(upload.status == UPLOAD_FILE_ABORTED){
     Update.end();
     DEBUG_PRINTLN(F("aborted"));
@@ -1680,47 +3323,42 @@ void on_ap_upload() {
   delay(0);
 }
 
+void on_ap_upload() { on_sta_upload(); }
+
 void start_server_client() {
-  wifi_server->on("/", server_home);  // handle home page
-  wifi_server->on("/index.html", server_home);
-  wifi_server->on("/update", HTTP_GET, on_sta_update); // handle firmware update
-  wifi_server->on("/update", HTTP_POST, on_sta_upload_fin, on_sta_upload);  
+  wifi_server->on("/", METERED(METRIC_HOME, server_home));  // handle home page
+  wifi_server->on("/index.html", METERED(METRIC_HOME, server_home));
+  wifi_server->on("/update", HTTP_GET, METERED(METRIC_UPDATE, on_sta_update)); // handle firmware update
+  wifi_server->on("/update", HTTP_POST, METERED(METRIC_UPLOAD, on_sta_upload_fin), on_sta_upload);  
   
   // set up all other handlers
-  char uri[4];
-  uri[0]='/';
-  uri[3]=0;
-  for(int i=0;i<sizeof(urls)/sizeof(URLHandler);i++) {
-    uri[1]=pgm_read_byte(_url_keys+2*i);
-    uri[2]=pgm_read_byte(_url_keys+2*i+1);
-    wifi_server->on(uri, urls[i]);
-  }
+  wifi_server->addHandler(new URLRouter());
+  wifi_server->collectHeaders(url_headers, sizeof(url_headers)/sizeof(url_headers[0]));
+#if defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR>=3)
+  // keep connections from other controllers (remote stations) open between requests
+  wifi_server->keepAlive(true);
+#endif
   wifi_server->begin();
 }
 
 void start_server_ap() {
 
-  scanned_ssids = scan_network();
-  String ap_ssid = get_ap_ssid();
-  start_network_ap(ap_ssid.c_str(), NULL);
+  char ap_ssid[AP_SSID_SIZE];
+  get_ap_ssid(ap_ssid);
+  start_network_ap(ap_ssid, NULL);
+  scan_next = millis();  // first scan right away, in the background
   delay(500);
-  wifi_server->on("/", on_ap_home);
-  wifi_server->on("/jsap", on_ap_scan);
-  wifi_server->on("/ccap", on_ap_change_config);
-  wifi_server->on("/jtap", on_ap_try_connect);
-  wifi_server->on("/update", HTTP_GET, on_ap_update);
-  wifi_server->on("/update", HTTP_POST, on_ap_upload_fin, on_ap_upload);
-  wifi_server->onNotFound(on_ap_home);
+  wifi_server->on("/", METERED(METRIC_AP_HOME, on_ap_home));
+  wifi_server->on("/jsap", METERED(METRIC_AP_SCAN, on_ap_scan));
+  wifi_server->on("/ccap", METERED(METRIC_AP_CONFIG, on_ap_change_config));
+  wifi_server->on("/jtap", METERED(METRIC_AP_CONNECT, on_ap_try_connect));
+  wifi_server->on("/update", HTTP_GET, METERED(METRIC_UPDATE, on_ap_update));
+  wifi_server->on("/update", HTTP_POST, METERED(METRIC_UPLOAD, on_ap_upload_fin), on_ap_upload);
+  wifi_server->onNotFound(METERED(METRIC_AP_HOME, on_ap_home));
 
   // set up all other handlers
-  char uri[4];
-  uri[0]='/';
-  uri[3]=0;
-  for(int i=0;i<sizeof(urls)/sizeof(URLHandler);i++) {
-    uri[1]=pgm_read_byte(_url_keys+2*i);
-    uri[2]=pgm_read_byte(_url_keys+2*i+1);
-    wifi_server->on(uri, urls[i]);
-  }
+  wifi_server->addHandler(new URLRouter());
+  wifi_server->collectHeaders(url_headers, sizeof(url_headers)/sizeof(url_headers[0]));
   
   wifi_server->begin();
   Serial.println("");
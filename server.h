@@ -24,13 +24,117 @@
 #ifndef _SERVER_H
 #define _SERVER_H
 
+/** Called by BufferFiller with the buffer content when the buffer is full */
+typedef void (*BufferFlush)(const char *data, unsigned int len);
+
+/** Bounded buffer writer
+ * The buffer size is always respected: once the buffer is full, its content
+ * is handed to the flush callback and the buffer starts over, or, if there is
+ * no flush callback, further output is dropped.
+ * Format codes of emit_p:
+ *   $D int   $L unsigned long   $S RAM string   $F PROGMEM string   $E NVM string
+ *   $J RAM string with JSON escaping   $N NVM string with JSON escaping
+ */
 class BufferFiller {
     char *start; //!< Pointer to start of buffer
     char *ptr; //!< Pointer to cursor position
+    char *end; //!< Pointer to the last byte of the buffer (reserved for the terminating 0)
+    BufferFlush flush_cb; //!< Flush callback (NULL: truncate)
+    bool truncated; //!< Output has been dropped because the buffer was full
 public:
-    BufferFiller () {}
+    BufferFiller () : start(NULL), ptr(NULL), end(NULL), flush_cb(NULL), truncated(false) {}
+
+    BufferFiller (char *buf, unsigned int size, BufferFlush cb=NULL) : start (buf), ptr (buf), end (buf+size-1), flush_cb (cb), truncated(false) {
+        *ptr = 0;
+    }
+
+    void put(char c) {
+        if (ptr >= end) {
+            if (!flush_cb) {
+                truncated = true;
+                return;
+            }
+            flush();
+        }
+        *ptr++ = c;
+    }
+
+    /** Copy len bytes of RAM data in as few pieces as possible */
+    void emit_mem(const char *s, unsigned int len) {
+        while (len) {
+            if (ptr >= end) {
+                if (!flush_cb) {
+                    truncated = true;
+                    break;
+                }
+                flush();
+            }
+            unsigned int n = end - ptr;
+            if (n > len) n = len;
+            memcpy(ptr, s, n);
+            ptr += n;
+            s += n;
+            len -= n;
+        }
+        *ptr = 0;
+    }
+
+    /** Hand the buffer content to the flush callback and start over */
+    void flush() {
+        *ptr = 0;
+        if (flush_cb && ptr > start)
+            flush_cb(start, ptr - start);
+        ptr = start;
+        *ptr = 0;
+    }
+
+    void emit_str(const char *s) {
+        emit_mem(s, strlen(s));
+    }
+
+    void emit_ulong(unsigned long v) {
+        char buf[11];
+        ultoa(v, buf, 10);
+        emit_str(buf);
+    }
+
+    void emit_int(int v) {
+        char buf[12];
+        itoa(v, buf, 10);
+        emit_str(buf);
+    }
 
-    BufferFiller (char *buf) : start (buf), ptr (buf) {}
+    void emit_pstr(PGM_P s) {
+        char d;
+        while ((d = pgm_read_byte(s++)) != 0) put(d);
+    }
+
+    void emit_nvm(const byte *s, bool json=false) {
+        char d;
+        while ((d = nvm_read_byte(s++)) != 0) {
+            if (json) emit_json_char(d);
+            else put(d);
+        }
+    }
+
+    void emit_json_char(char c) {
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(c);
+        } else if ((byte)c < 0x20) {
+            // control characters are written as \u00XX
+            const char *hex = "0123456789abcdef";
+            emit_str("\\u00");
+            put(hex[(byte)c >> 4]);
+            put(hex[c & 0x0F]);
+        } else {
+            put(c);
+        }
+    }
+
+    void emit_json(const char *s) {
+        while (*s) emit_json_char(*s++);
+    }
 
     void emit_p(PGM_P fmt, ...) {
         va_list ap;
@@ -40,48 +144,119 @@ public:
             if (c == 0)
                 break;
             if (c != '$') {
-                *ptr++ = c;
+                put(c);
                 continue;
             }
             c = pgm_read_byte(fmt++);
             switch (c) {
             case 'D':
-                //wtoa(va_arg(ap, uint16_t), (char*) ptr);
-                itoa(va_arg(ap, int), (char*) ptr, 10);  // ray
+                emit_int(va_arg(ap, int));
                 break;
             case 'L':
-                //ltoa(va_arg(ap, long), (char*) ptr, 10);
-                ultoa(va_arg(ap, long), (char*) ptr, 10); // ray
+                emit_ulong(va_arg(ap, unsigned long));
                 break;
             case 'S':
-                strcpy((char*) ptr, va_arg(ap, const char*));
+                emit_str(va_arg(ap, const char*));
+                break;
+            case 'J':
+                emit_json(va_arg(ap, const char*));
+                break;
+            case 'F':
+                emit_pstr(va_arg(ap, PGM_P));
+                break;
+            case 'E':
+                emit_nvm(va_arg(ap, byte*));
+                break;
+            case 'N':
+                emit_nvm(va_arg(ap, byte*), true);
                 break;
-            case 'F': {
-                PGM_P s = va_arg(ap, PGM_P);
-                char d;
-                while ((d = pgm_read_byte(s++)) != 0)
-                    *ptr++ = d;
-                continue;
-            }
-            case 'E': {
-                byte* s = va_arg(ap, byte*);
-                char d;
-                while ((d = nvm_read_byte(s++)) != 0)
-                    *ptr++ = d;
-                continue;
-            }
             default:
-                *ptr++ = c;
-                continue;
+                put(c);
+                break;
             }
-            ptr += strlen((char*) ptr);
         }
-        *(ptr)=0;        
+        *(ptr)=0;
         va_end(ap);
     }
 
+    bool overflow () const { return truncated; }
     char* buffer () const { return start; }
     unsigned int position () const { return ptr - start; }
 };
 
+/** Streaming CBOR (RFC 7049) encoder
+ * Items are written straight into a BufferFiller as they are produced.
+ * Maps and arrays whose size is not known up front use the indefinite-length
+ * form and are closed with end().
+ */
+class CBORWriter {
+    BufferFiller &out;
+
+    /** Write the initial byte(s) of an item: major type and argument */
+    void head(byte major, unsigned long v) {
+        major <<= 5;
+        if (v < 24) {
+            out.put(major | v);
+        } else if (v < 0x100) {
+            out.put(major | 24);
+            out.put(v);
+        } else if (v < 0x10000) {
+            out.put(major | 25);
+            out.put(v >> 8);
+            out.put(v);
+        } else {
+            out.put(major | 26);
+            out.put(v >> 24);
+            out.put(v >> 16);
+            out.put(v >> 8);
+            out.put(v);
+        }
+    }
+public:
+    CBORWriter (BufferFiller &f) : out (f) {}
+
+    void map() { out.put(0xBF); }
+    void array() { out.put(0x9F); }
+    void array(unsigned int n) { head(4, n); }
+    void end() { out.put(0xFF); }
+
+    void uint(unsigned long v) { head(0, v); }
+
+    void integer(long v) {
+        if (v < 0) head(1, (unsigned long)(-1-v));
+        else head(0, v);
+    }
+
+    void real(float f) {
+        union { float f; uint32_t u; } v;
+        v.f = f;
+        out.put(0xFA);
+        out.put(v.u >> 24);
+        out.put(v.u >> 16);
+        out.put(v.u >> 8);
+        out.put(v.u);
+    }
+
+    void text(const char *s, unsigned int len) {
+        head(3, len);
+        out.emit_mem(s, len);
+    }
+
+    void text(const char *s) { text(s, strlen(s)); }
+
+    /** PROGMEM string, also used for map keys */
+    void text_p(PGM_P s) {
+        head(3, strlen_P(s));
+        out.emit_pstr(s);
+    }
+
+    /** NVM string */
+    void text_nvm(const byte *s) {
+        unsigned int len = 0;
+        while (nvm_read_byte(s+len)) len++;
+        head(3, len);
+        out.emit_nvm(s);
+    }
+};
+
 #endif // _SERVER_H
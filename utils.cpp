@@ -83,7 +83,30 @@ void remove_file(const char *name) {
 
 // nvm functions for ESP8266
 // do not use File.readBytes or readBytesUntil because it's very slow
+
+// NVM transaction: between nvm_begin and nvm_commit the NVM file is kept
+// open, so a series of reads and writes costs a single open and a single
+// flush and close of the file
+static File nvm_file;
+static byte nvm_depth = 0;
+
+void nvm_begin() {
+  if(nvm_depth++) return;
+  nvm_file = SPIFFS.open(NVM_FILENAME, "r+");
+  if(!nvm_file) nvm_file = SPIFFS.open(NVM_FILENAME, "w+");
+}
+
+void nvm_commit() {
+  if(!nvm_depth || --nvm_depth) return;
+  if(nvm_file) nvm_file.close();
+}
+
 void nvm_read_block(void *dst, const void *src, int len) {
+  if(nvm_depth && nvm_file) {
+    nvm_file.seek((unsigned int)src, SeekSet);
+    nvm_file.read((byte*)dst, len);
+    return;
+  }
   File f = SPIFFS.open(NVM_FILENAME, "r");
   if(f) {
     f.seek((unsigned int)src, SeekSet);
@@ -93,6 +116,11 @@ void nvm_read_block(void *dst, const void *src, int len) {
 }
 
 void nvm_write_block(const void *src, void *dst, int len) {
+  if(nvm_depth && nvm_file) {
+    nvm_file.seek((unsigned int)dst, SeekSet);
+    nvm_file.write((byte*)src, len);
+    return;
+  }
   File f = SPIFFS.open(NVM_FILENAME, "r+");
   if(!f) f = SPIFFS.open(NVM_FILENAME, "w");
   if(f) {
@@ -103,8 +131,13 @@ void nvm_write_block(const void *src, void *dst, int len) {
 }
 
 byte nvm_read_byte(const byte *p) {
-  File f = SPIFFS.open(NVM_FILENAME, "r");
   byte v = 0;
+  if(nvm_depth && nvm_file) {
+    nvm_file.seek((unsigned int)p, SeekSet);
+    nvm_file.read((byte*)&v, 1);
+    return v;
+  }
+  File f = SPIFFS.open(NVM_FILENAME, "r");
   if(f) {
     f.seek((unsigned int)p, SeekSet);
     f.read((byte*)&v, 1);
@@ -114,6 +147,11 @@ byte nvm_read_byte(const byte *p) {
 }
 
 void nvm_write_byte(const byte *p, byte v) {
+  if(nvm_depth && nvm_file) {
+    nvm_file.seek((unsigned int)p, SeekSet);
+    nvm_file.write(&v, 1);
+    return;
+  }
   File f = SPIFFS.open(NVM_FILENAME, "r+");
   if(!f) f = SPIFFS.open(NVM_FILENAME, "w");
   if(f) {
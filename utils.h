@@ -40,6 +40,8 @@ void nvm_read_block(void *dst, const void *src, int len);
 void nvm_write_block(const void *src, void *dst, int len);
 byte nvm_read_byte(const byte *p);
 void nvm_write_byte(const byte *p, byte v);  
+void nvm_begin();   // start an NVM transaction
+void nvm_commit();  // end an NVM transaction
 // NVM functions
 
 #endif // _UTILS_H
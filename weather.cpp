@@ -147,7 +147,7 @@ void GetWeather() {
 
   char tmp[60];
   read_from_file(wtopts_filename, tmp, 60);
-  BufferFiller bf = tmp_buffer;
+  BufferFiller bf(tmp_buffer, TMP_BUFFER_SIZE);
   bf.emit_p(PSTR("$D.py?loc=$E&key=$E&fwv=$D&wto=$S"),
                 (int) os.options[OPTION_USE_WEATHER],
                 ADDR_NVM_LOCATION,